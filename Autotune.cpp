@@ -0,0 +1,188 @@
+#include "Autotune.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <gmpxx.h>
+#include "MontgomeryCurve.h"
+#include "MpzUtils.h"
+#include "QuadraticSieve.h"
+
+namespace {
+    constexpr std::chrono::milliseconds MEASURE_TIME{100};     // per operation and size
+
+    // calls f in rounds of 64 until MEASURE_TIME has passed
+    template<typename F>
+    double ns_per_call(F&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t calls = 0;
+        std::chrono::nanoseconds elapsed;
+        do {
+            for (int i = 0; i < 64; ++i) f();
+            calls += 64;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < MEASURE_TIME);
+        return static_cast<double>(elapsed.count()) / static_cast<double>(calls);
+    }
+
+    // two fixed primes of 25 digits; below 50 digits the sieve's setup costs hide how it scales
+    mpz_class reference_semiprime() {
+        mpz_class p("3141592653589793238462643"), q("2718281828459045235360287");
+        mpz_nextprime(p.get_mpz_t(), p.get_mpz_t());
+        mpz_nextprime(q.get_mpz_t(), q.get_mpz_t());
+        return p * q;
+    }
+
+    // L(n) = exp(sqrt(ln n ln ln n)), the sieve's running time up to a constant
+    double sieve_complexity(double log_n) {
+        return std::exp(std::sqrt(log_n * std::log(log_n)));
+    }
+
+    double interpolate(const std::array<double, TUNING_BITS.size()>& values, size_t bits) {
+        size_t i = 1;
+        while (i + 1 < TUNING_BITS.size() && TUNING_BITS[i] < bits) ++i;
+        const double x0 = std::log2(static_cast<double>(TUNING_BITS[i - 1]));
+        const double x1 = std::log2(static_cast<double>(TUNING_BITS[i]));
+        const double y0 = std::log2(values[i - 1]);
+        const double y1 = std::log2(values[i]);
+        const double x = std::log2(static_cast<double>(std::max<size_t>(bits, 2)));
+        return std::exp2(y0 + (y1 - y0) * (x - x0) / (x1 - x0));
+    }
+
+    double prime_count(double x) {
+        return x > 2 ? x / std::log(x) : 0;
+    }
+
+    void write_row(std::ostream& out, const std::string& key, const std::array<double, TUNING_BITS.size()>& values) {
+        out << key;
+        for (double v : values) out << ' ' << v;
+        out << '\n';
+    }
+
+    bool read_row(std::istringstream& in, std::array<double, TUNING_BITS.size()>& values) {
+        for (double& v : values) {
+            if (!(in >> v) || v <= 0) return false;
+        }
+        return true;
+    }
+}
+
+TuningProfile run_autotune() {
+    TuningProfile profile;
+    gmp_randclass rng(gmp_randinit_mt);
+    rng.seed(12345);
+
+    for (size_t s = 0; s < TUNING_BITS.size(); ++s) {
+        const size_t bits = TUNING_BITS[s];
+        mpz_class n = rng.get_z_bits(bits);
+        mpz_setbit(n.get_mpz_t(), bits - 1);
+        mpz_setbit(n.get_mpz_t(), 0);
+        const mpz_class b = rng.get_z_range(n);
+
+        // one Montgomery ladder step, the unit scalar_multiply is made of
+        const MontgomeryCurve curve(rng.get_z_range(n), n);
+        const MontgomeryPoint P{rng.get_z_range(n), 1};
+        MontgomeryPoint R0 = P, R1 = curve.double_point(P);
+        profile.curve_step_ns[s] = ns_per_call([&]() {
+            R1 = curve.add_points(R0, R1, P);
+            R0 = curve.double_point(R0);
+        });
+
+        mpz_class g;
+        profile.gcd_ns[s] = ns_per_call([&]() {
+            mpz_gcd(g.get_mpz_t(), b.get_mpz_t(), n.get_mpz_t());
+        });
+
+        uint64_t divisor = (1ULL << 32) + 1;
+        volatile bool divisible;    // keeps the test from being optimized away
+        profile.trial_division_ns[s] = ns_per_call([&]() {
+            divisible = mpz_divisible_u64_p(n, divisor);
+            divisor += 2;
+        });
+
+        std::cout << std::setw(5) << bits << " bits: curve step " << std::fixed << std::setprecision(1)
+                  << profile.curve_step_ns[s] << " ns, gcd "
+                  << profile.gcd_ns[s] << " ns, trial division " << profile.trial_division_ns[s] << " ns"
+                  << std::defaultfloat << std::endl;
+    }
+
+    const mpz_class reference = reference_semiprime();
+    std::cout << "sieving the " << mpz_sizeinbase(reference.get_mpz_t(), 10) << " digit reference number..." << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    siqs_factor(reference, 1);
+    profile.siqs_reference_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "sieve: " << profile.siqs_reference_seconds << " s" << std::endl;
+
+    profile.loaded = true;
+    return profile;
+}
+
+bool save_tuning_profile(const TuningProfile& profile, const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    out << "# RSA tuning profile, rewrite it with [O]->[T] after changing the machine or the build\n";
+    out << "bits";
+    for (size_t bits : TUNING_BITS) out << ' ' << bits;
+    out << '\n';
+    write_row(out, "curve_step_ns", profile.curve_step_ns);
+    write_row(out, "gcd_ns", profile.gcd_ns);
+    write_row(out, "trial_division_ns", profile.trial_division_ns);
+    out << "siqs_reference_seconds " << profile.siqs_reference_seconds << '\n';
+    return static_cast<bool>(out);
+}
+
+bool load_tuning_profile(TuningProfile& profile, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    TuningProfile loaded;
+    unsigned found = 0;     // one bit per required key
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key) || key[0] == '#') continue;
+        if (key == "bits") {
+            // measurements of other sizes can't be interpolated the same way
+            for (size_t bits : TUNING_BITS) {
+                size_t value;
+                if (!(fields >> value) || value != bits) return false;
+            }
+            found |= 1;
+        }
+        else if (key == "curve_step_ns") { if (!read_row(fields, loaded.curve_step_ns)) return false; found |= 2; }
+        else if (key == "gcd_ns") { if (!read_row(fields, loaded.gcd_ns)) return false; found |= 4; }
+        else if (key == "trial_division_ns") { if (!read_row(fields, loaded.trial_division_ns)) return false; found |= 8; }
+        else if (key == "siqs_reference_seconds") {
+            if (!(fields >> loaded.siqs_reference_seconds) || loaded.siqs_reference_seconds <= 0) return false;
+            found |= 16;
+        }
+    }
+    if (found != 31) return false;
+    loaded.loaded = true;
+    profile = loaded;
+    return true;
+}
+
+double ecm_curve_seconds(const TuningProfile& profile, unsigned long B1, unsigned long B2, size_t bits) {
+    const double step = interpolate(profile.curve_step_ns, bits);
+    const double gcd = interpolate(profile.gcd_ns, bits);
+    const double stage1 = M_LOG2E * static_cast<double>(B1) * step + gcd;
+    const double stage2 = std::max(0.0, prime_count(static_cast<double>(B2)) - prime_count(static_cast<double>(B1)))
+                        * (std::log2(static_cast<double>(B2)) * step + gcd);
+    return (stage1 + stage2) * 1e-9;
+}
+
+double siqs_seconds(const TuningProfile& profile, size_t digits) {
+    const mpz_class reference = reference_semiprime();
+    const double reference_log = std::log(reference.get_d());
+    const double log_n = static_cast<double>(digits) * std::log(10.0);
+    return profile.siqs_reference_seconds * sieve_complexity(log_n) / sieve_complexity(reference_log);
+}
+
+double trial_division_seconds(const TuningProfile& profile, uint64_t primes, size_t bits) {
+    return static_cast<double>(primes) * interpolate(profile.trial_division_ns, bits) * 1e-9;
+}
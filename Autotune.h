@@ -0,0 +1,42 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Speeds of the basic operations on this machine, measured once by run_autotune and kept in a profile
+// file next to the binary's working directory. The cost model below turns them into B1 choices and
+// algorithm switch points, without a profile the defaults are the ones the menus always used.
+constexpr std::array<size_t, 5> TUNING_BITS = {128, 256, 512, 1024, 2048};   // sizes of n that get measured
+constexpr const char* TUNING_PROFILE_FILE = "rsa_tuning.profile";
+// B2 = ECM_B2_RATIO * B1 on every host. Both stages are made of the same ladder steps: stage 1 about
+// log2(e) = 1.44 B1 of them, stage 2 about log2(q) plus a gcd for every prime q in (B1, B2]. The primes
+// in (B1, 2 B1] alone already cost as much as stage 1, whatever the speed of the machine.
+constexpr unsigned long ECM_B2_RATIO = 2;
+// B2 = PM1_B2_RATIO * B1 for p-1 and p+1. Their stage 2 is a baby-step/giant-step continuation on a single
+// residue, about one multiplication per prime instead of a ladder, so 50 B1 stays within about twice stage 1.
+constexpr unsigned long PM1_B2_RATIO = 50;
+
+struct TuningProfile {
+    bool loaded = false;
+    // per size of TUNING_BITS, in nanoseconds
+    std::array<double, TUNING_BITS.size()> curve_step_ns{};     // double_point + add_points, one ladder step
+    std::array<double, TUNING_BITS.size()> gcd_ns{};            // gcd(z, n)
+    std::array<double, TUNING_BITS.size()> trial_division_ns{}; // n mod p for one word sized p
+    double siqs_reference_seconds = 0;  // siqs_factor on one thread for a fixed 50 digit semiprime
+};
+
+// Microbenchmarks every operation on random n of each size and the sieve on the reference number.
+// Takes a few seconds, prints what it measured.
+TuningProfile run_autotune();
+
+// Plain "key value..." lines, unknown keys are skipped so older profiles keep loading.
+bool save_tuning_profile(const TuningProfile& profile, const std::string& path);
+bool load_tuning_profile(TuningProfile& profile, const std::string& path);
+
+// Cost model, all in seconds on one thread. Measurements between two sizes are interpolated log-log.
+double ecm_curve_seconds(const TuningProfile& profile, unsigned long B1, unsigned long B2, size_t bits);
+double siqs_seconds(const TuningProfile& profile, size_t digits);
+double trial_division_seconds(const TuningProfile& profile, uint64_t primes, size_t bits);
+
+#endif //AUTOTUNE_H
@@ -0,0 +1,155 @@
+#include "BatchGcd.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "HartLehman.h"
+#include "MpzUtils.h"
+#include "PrimeSieve.h"
+#include "ProductTree.h"
+
+namespace {
+    constexpr size_t MAX_GROUP_BITS = 1ULL << 28;   // 32 MB of moduli, tree and squares stay below ~1 GB per thread
+    constexpr size_t MIN_GROUP_MODULI = 256;        // below this the cross products cost more than the threads gain
+
+    struct Group {
+        size_t first;
+        size_t last;    // one past the end
+    };
+
+    // f(g) for every group, the threads take the next group as soon as they are done
+    void for_each_group(size_t count, unsigned num_threads, const std::function<void(size_t)>& f) {
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < std::min<size_t>(num_threads, count); ++t) {
+            threads.emplace_back([&]() {
+                for (size_t g = next++; g < count; g = next++) f(g);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    std::vector<mpz_class> slice(const std::vector<mpz_class>& moduli, const Group& group) {
+        return {moduli.begin() + static_cast<std::ptrdiff_t>(group.first), moduli.begin() + static_cast<std::ptrdiff_t>(group.last)};
+    }
+
+    // groups of about equal size in bits, at least one per thread once there are enough moduli
+    std::vector<Group> split_groups(const std::vector<mpz_class>& moduli, unsigned num_threads) {
+        size_t total_bits = 0;
+        for (const mpz_class& n : moduli) total_bits += mpz_sizeinbase(n.get_mpz_t(), 2);
+        const size_t group_count = std::max({(total_bits + MAX_GROUP_BITS - 1) / MAX_GROUP_BITS,
+                                             std::min<size_t>(num_threads, moduli.size() / MIN_GROUP_MODULI), size_t(1)});
+        const size_t group_bits = total_bits / group_count + 1;
+        std::vector<Group> groups;
+        size_t bits = 0;
+        for (size_t i = 0, first = 0; i < moduli.size(); ++i) {
+            bits += mpz_sizeinbase(moduli[i].get_mpz_t(), 2);
+            if (bits >= group_bits || i + 1 == moduli.size()) {
+                groups.push_back({first, i + 1});
+                first = i + 1;
+                bits = 0;
+            }
+        }
+        return groups;
+    }
+
+    // g is a product of distinct primes up to the bound
+    uint64_t smallest_prime(const mpz_class& g, uint64_t bound) {
+        if (mpz_fits_u64(g)) {
+            const uint64_t value = mpz_get_u64(g);
+            if (is_prime_u64(value)) return value;
+            const uint64_t factor = factor_u64(value);
+            return std::min(smallest_prime(mpz_from_u64(factor), bound), smallest_prime(mpz_from_u64(value / factor), bound));
+        }
+        // too many primes for one word, only happens for moduli that are smooth all the way
+        PrimeSieve sieve(2, bound);
+        std::vector<uint64_t> primes;
+        while (sieve.next_segment(primes)) {
+            for (uint64_t p : primes) {
+                if (mpz_divisible_u64_p(g, p)) return p;
+            }
+        }
+        return 0;
+    }
+}
+
+std::vector<mpz_class> batch_gcd(const std::vector<mpz_class>& moduli, unsigned num_threads) {
+    if (num_threads == 0) num_threads = 1;
+    std::vector<mpz_class> result(moduli.size(), 1);
+    if (moduli.size() < 2) return result;
+
+    const std::vector<Group> groups = split_groups(moduli, num_threads);
+    std::vector<mpz_class> products(groups.size());
+    for_each_group(groups.size(), num_threads, [&](size_t g) {
+        products[g] = ProductTree(slice(moduli, groups[g])).root();
+    });
+
+    for_each_group(groups.size(), num_threads, [&](size_t g) {
+        // P mod products[g]^2, one group's product at a time
+        const mpz_class square = products[g] * products[g];
+        mpz_class x = 1, residue;
+        for (size_t k = 0; k < products.size(); ++k) {
+            mpz_mod(residue.get_mpz_t(), products[k].get_mpz_t(), square.get_mpz_t());
+            x *= residue;
+            mpz_mod(x.get_mpz_t(), x.get_mpz_t(), square.get_mpz_t());
+        }
+
+        const std::vector<mpz_class> remainders = ProductTree(slice(moduli, groups[g])).remainders_squared(x);
+        mpz_class quotient;
+        for (size_t i = 0; i < remainders.size(); ++i) {
+            const mpz_class& n = moduli[groups[g].first + i];
+            mpz_divexact(quotient.get_mpz_t(), remainders[i].get_mpz_t(), n.get_mpz_t());
+            mpz_gcd(result[groups[g].first + i].get_mpz_t(), quotient.get_mpz_t(), n.get_mpz_t());
+        }
+    });
+
+    // both primes shared: n_i has one prime in common with some other hit, a pairwise gcd separates them
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < moduli.size(); ++i) {
+        if (result[i] != 1) hits.push_back(i);
+    }
+    mpz_class g;
+    for (size_t i : hits) {
+        if (result[i] != moduli[i]) continue;
+        for (size_t j : hits) {
+            mpz_gcd(g.get_mpz_t(), moduli[i].get_mpz_t(), moduli[j].get_mpz_t());
+            if (g != 1 && g != moduli[i]) {
+                result[i] = g;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<uint64_t> batch_small_factors(const std::vector<mpz_class>& moduli, uint64_t bound, unsigned num_threads) {
+    if (num_threads == 0) num_threads = 1;
+    bound = std::min(bound, MAX_SMALL_FACTOR_BOUND);
+    std::vector<uint64_t> result(moduli.size(), 0);
+    if (moduli.empty() || bound < 2) return result;
+
+    // product of all primes up to the bound, one small tree per sieve segment and one over the segments
+    std::vector<mpz_class> segment_products;
+    PrimeSieve sieve(2, bound);
+    std::vector<uint64_t> primes;
+    while (sieve.next_segment(primes)) {
+        std::vector<mpz_class> leaves;
+        leaves.reserve(primes.size());
+        for (uint64_t p : primes) leaves.push_back(mpz_from_u64(p));
+        segment_products.push_back(ProductTree(std::move(leaves)).root());
+    }
+    const mpz_class prime_product = ProductTree(std::move(segment_products)).root();
+
+    const std::vector<Group> groups = split_groups(moduli, num_threads);
+    for_each_group(groups.size(), num_threads, [&](size_t g) {
+        const ProductTree tree(slice(moduli, groups[g]));
+        const std::vector<mpz_class> remainders = tree.remainders(prime_product);
+        mpz_class common;
+        for (size_t i = 0; i < remainders.size(); ++i) {
+            const mpz_class& n = moduli[groups[g].first + i];
+            mpz_gcd(common.get_mpz_t(), remainders[i].get_mpz_t(), n.get_mpz_t());
+            if (common != 1) result[groups[g].first + i] = smallest_prime(common, bound);
+        }
+    });
+    return result;
+}
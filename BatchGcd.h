@@ -0,0 +1,25 @@
+#ifndef BATCHGCD_H
+#define BATCHGCD_H
+#include <cstdint>
+#include <vector>
+#include <gmpxx.h>
+
+// Bernstein's batch gcd, as used by Heninger et al. to audit public keys in bulk.
+// With P the product of all moduli, (P mod n_i^2) / n_i = P / n_i mod n_i, so one gcd per modulus shows
+// whether it shares a prime with any other. The moduli are split into groups so that only one group's
+// product tree per thread is in memory: a group gets P mod (its product)^2 from the products of the other
+// groups and then goes down its own remainder tree.
+// Returns gcd(n_i, product of the other moduli) for every modulus: 1 if it shares nothing, a prime if it
+// shares one, and n_i if both primes are shared (or n_i is listed twice) and no pairwise gcd splits it.
+std::vector<mpz_class> batch_gcd(const std::vector<mpz_class>& moduli, unsigned num_threads);
+
+// Largest bound batch_small_factors accepts, the product of the primes up to it is about 190 MB
+constexpr uint64_t MAX_SMALL_FACTOR_BOUND = 1ULL << 30;
+
+// Trial division of a whole corpus at once: the product of all primes up to bound is reduced modulo every
+// modulus through a remainder tree of the moduli, gcd(remainder, n_i) is then the product of the small
+// primes dividing n_i. Near linear in the size of the input instead of moduli times primes.
+// Returns the smallest prime factor up to bound of every modulus, or 0 where there is none.
+std::vector<uint64_t> batch_small_factors(const std::vector<mpz_class>& moduli, uint64_t bound, unsigned num_threads);
+
+#endif //BATCHGCD_H
@@ -0,0 +1,401 @@
+#include "BlockLanczos.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+
+namespace {
+    // surplus rows kept after clique removal, the null space of the filtered matrix has at least this dimension
+    constexpr size_t TARGET_EXCESS = 96;
+    // below this many rows per thread the matrix-vector product is not split
+    constexpr size_t MIN_ROWS_PER_THREAD = 4096;
+    constexpr int MAX_ATTEMPTS = 3;
+
+    using Block = std::array<uint64_t, 64>;   // 64x64 matrix over GF(2), entry (i, j) is bit j of word i
+
+    // Matrix in compressed sparse row form (one row per relation) and the same entries by column,
+    // the column form lets B*v be computed without write conflicts between threads.
+    struct SparseMatrix {
+        size_t num_rows = 0;
+        size_t num_columns = 0;
+        std::vector<uint32_t> row_start, row_entries;
+        std::vector<uint32_t> column_start, column_entries;
+    };
+
+    struct Filtered {
+        SparseMatrix matrix;
+        std::vector<size_t> original_row;   // input row of every matrix row
+    };
+
+    size_t find_root(std::vector<size_t>& parent, size_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    }
+
+    Filtered filter(const std::vector<std::vector<uint32_t>>& rows, size_t num_columns) {
+        std::vector<uint8_t> alive(rows.size(), 1);
+        std::vector<uint32_t> weight(num_columns, 0);
+        for (const auto& row : rows) {
+            for (uint32_t c : row) ++weight[c];
+        }
+        auto remove = [&](size_t r) {
+            alive[r] = 0;
+            for (uint32_t c : rows[r]) --weight[c];
+        };
+
+        for (bool changed = true; changed;) {
+            changed = false;
+            // singletons: a column that only one row touches can never cancel, so that row is useless
+            for (bool found = true; found;) {
+                found = false;
+                for (size_t r = 0; r < rows.size(); ++r) {
+                    if (!alive[r]) continue;
+                    if (std::any_of(rows[r].begin(), rows[r].end(), [&](uint32_t c) { return weight[c] == 1; })) {
+                        remove(r);
+                        found = changed = true;
+                    }
+                }
+            }
+
+            // cliques: rows joined by columns of weight two, deleting one of them turns the rest into singletons.
+            // Drop the largest cliques first while there are more surplus rows than needed.
+            const size_t live_rows = std::count(alive.begin(), alive.end(), 1);
+            const size_t live_columns = std::count_if(weight.begin(), weight.end(), [](uint32_t w) { return w > 0; });
+            if (live_rows <= live_columns + TARGET_EXCESS) break;
+            size_t surplus = live_rows - live_columns - TARGET_EXCESS;
+
+            std::vector<size_t> parent(rows.size());
+            std::iota(parent.begin(), parent.end(), 0);
+            std::vector<size_t> first_row(num_columns, SIZE_MAX);
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (!alive[r]) continue;
+                for (uint32_t c : rows[r]) {
+                    if (weight[c] != 2) continue;
+                    if (first_row[c] == SIZE_MAX) first_row[c] = r;
+                    else parent[find_root(parent, r)] = find_root(parent, first_row[c]);
+                }
+            }
+            std::vector<size_t> clique_size(rows.size(), 0);
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (alive[r]) ++clique_size[find_root(parent, r)];
+            }
+            std::vector<size_t> cliques;
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (alive[r] && clique_size[r] > 1) cliques.push_back(r);
+            }
+            std::sort(cliques.begin(), cliques.end(), [&](size_t a, size_t b) { return clique_size[a] > clique_size[b]; });
+
+            std::vector<uint8_t> doomed(rows.size(), 0);
+            for (size_t root : cliques) {
+                if (clique_size[root] > surplus) continue;
+                surplus -= clique_size[root];
+                doomed[root] = 1;
+            }
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (alive[r] && doomed[find_root(parent, r)]) {
+                    remove(r);
+                    changed = true;
+                }
+            }
+        }
+
+        // renumber the surviving columns densely and build both compressed forms
+        Filtered result;
+        std::vector<uint32_t> column_index(num_columns, UINT32_MAX);
+        SparseMatrix& m = result.matrix;
+        for (size_t c = 0; c < num_columns; ++c) {
+            if (weight[c] > 0) column_index[c] = static_cast<uint32_t>(m.num_columns++);
+        }
+        m.row_start.push_back(0);
+        for (size_t r = 0; r < rows.size(); ++r) {
+            if (!alive[r]) continue;
+            result.original_row.push_back(r);
+            for (uint32_t c : rows[r]) m.row_entries.push_back(column_index[c]);
+            m.row_start.push_back(static_cast<uint32_t>(m.row_entries.size()));
+        }
+        m.num_rows = result.original_row.size();
+
+        m.column_start.assign(m.num_columns + 1, 0);
+        for (uint32_t c : m.row_entries) ++m.column_start[c + 1];
+        std::partial_sum(m.column_start.begin(), m.column_start.end(), m.column_start.begin());
+        m.column_entries.resize(m.row_entries.size());
+        std::vector<uint32_t> fill(m.column_start.begin(), m.column_start.end() - 1);
+        for (size_t r = 0; r < m.num_rows; ++r) {
+            for (uint32_t i = m.row_start[r]; i < m.row_start[r + 1]; ++i) {
+                m.column_entries[fill[m.row_entries[i]]++] = static_cast<uint32_t>(r);
+            }
+        }
+        return result;
+    }
+
+    template <typename Body>
+    void parallel_for(size_t count, unsigned num_threads, Body body) {
+        const size_t chunks = std::clamp<size_t>(count / MIN_ROWS_PER_THREAD, 1, num_threads);
+        if (chunks == 1) {
+            body(0, count);
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < chunks; ++t) {
+            threads.emplace_back(body, count * t / chunks, count * (t + 1) / chunks);
+        }
+        for (auto& thread : threads) thread.join();
+    }
+
+    // product = B^T * B * v, with one 64 bit block per matrix row in v and product
+    void multiply_symmetric(const SparseMatrix& m, const std::vector<uint64_t>& v, std::vector<uint64_t>& product,
+                            std::vector<uint64_t>& scratch, unsigned num_threads) {
+        parallel_for(m.num_columns, num_threads, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                uint64_t sum = 0;
+                for (uint32_t i = m.column_start[c]; i < m.column_start[c + 1]; ++i) sum ^= v[m.column_entries[i]];
+                scratch[c] = sum;
+            }
+        });
+        parallel_for(m.num_rows, num_threads, [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; ++r) {
+                uint64_t sum = 0;
+                for (uint32_t i = m.row_start[r]; i < m.row_start[r + 1]; ++i) sum ^= scratch[m.row_entries[i]];
+                product[r] = sum;
+            }
+        });
+    }
+
+    Block multiply(const Block& a, const Block& b) {
+        Block c{};
+        for (size_t i = 0; i < 64; ++i) {
+            for (uint64_t bits = a[i]; bits; bits &= bits - 1) c[i] ^= b[std::countr_zero(bits)];
+        }
+        return c;
+    }
+
+    // y ^= v * m for N x 64 v, with the rows of m combined a byte at a time through lookup tables
+    void multiply_accumulate(const std::vector<uint64_t>& v, const Block& m, std::vector<uint64_t>& y) {
+        std::vector<uint64_t> table(8 * 256);
+        for (size_t k = 0; k < 8; ++k) {
+            for (size_t byte = 1; byte < 256; ++byte) {
+                const size_t low = std::countr_zero(byte);
+                table[k * 256 + byte] = table[k * 256 + (byte & (byte - 1))] ^ m[8 * k + low];
+            }
+        }
+        for (size_t i = 0; i < v.size(); ++i) {
+            uint64_t sum = 0;
+            for (size_t k = 0; k < 8; ++k) sum ^= table[k * 256 + ((v[i] >> (8 * k)) & 0xFF)];
+            y[i] ^= sum;
+        }
+    }
+
+    // x^T * y for two N x 64 blocks, summed per byte of x first and expanded to bits at the end
+    Block inner_product(const std::vector<uint64_t>& x, const std::vector<uint64_t>& y) {
+        std::vector<uint64_t> sums(8 * 256, 0);
+        for (size_t i = 0; i < x.size(); ++i) {
+            for (size_t k = 0; k < 8; ++k) sums[k * 256 + ((x[i] >> (8 * k)) & 0xFF)] ^= y[i];
+        }
+        Block c{};
+        for (size_t k = 0; k < 8; ++k) {
+            for (size_t byte = 1; byte < 256; ++byte) {
+                for (size_t bits = byte; bits; bits &= bits - 1) c[8 * k + std::countr_zero(bits)] ^= sums[k * 256 + byte];
+            }
+        }
+        return c;
+    }
+
+    // Montgomery's choice of the columns S_i: the largest set that makes S^T (V^T A V) S invertible while
+    // including every column left out last time. Returns the number of columns, s lists them and
+    // winv = S (S^T T S)^-1 S^T.
+    size_t find_nonsingular_sub(const Block& t, std::array<size_t, 64>& s, const std::array<size_t, 64>& last_s,
+                                size_t last_dim, Block& winv) {
+        std::array<std::array<uint64_t, 2>, 64> M;   // [T | I]
+        for (size_t i = 0; i < 64; ++i) M[i] = {t[i], 1ULL << i};
+
+        uint64_t last_mask = 0;
+        for (size_t i = 0; i < last_dim; ++i) last_mask |= 1ULL << last_s[i];
+        size_t cols = 0;
+        for (size_t i = 0; i < 64; ++i) {
+            if (!(last_mask & (1ULL << i))) s[cols++] = i;
+        }
+        for (size_t i = 0; i < last_dim; ++i) s[cols++] = last_s[i];
+
+        size_t dim = 0;
+        for (size_t i = 0; i < 64; ++i) {
+            const uint64_t mask = 1ULL << s[i];
+            size_t j = i;
+            while (j < 64 && !(M[s[j]][0] & mask)) ++j;
+            if (j < 64) {
+                std::swap(M[s[i]], M[s[j]]);
+                for (size_t k = 0; k < 64; ++k) {
+                    if (k != s[i] && (M[k][0] & mask)) {
+                        M[k][0] ^= M[s[i]][0];
+                        M[k][1] ^= M[s[i]][1];
+                    }
+                }
+                s[dim++] = s[i];
+                continue;
+            }
+
+            // no pivot in T, use the identity half to drop this column instead
+            j = i;
+            while (j < 64 && !(M[s[j]][1] & mask)) ++j;
+            if (j == 64) return 0;
+            std::swap(M[s[i]], M[s[j]]);
+            for (size_t k = 0; k < 64; ++k) {
+                if (k != s[i] && (M[k][1] & mask)) {
+                    M[k][0] ^= M[s[i]][0];
+                    M[k][1] ^= M[s[i]][1];
+                }
+            }
+            M[s[i]] = {0, 0};
+        }
+        for (size_t i = 0; i < 64; ++i) winv[i] = M[i][1];
+        return dim;
+    }
+
+    // One run of the iteration from a random start. On success x and v hold vectors whose combinations
+    // span most of the null space of B^T B.
+    bool lanczos_iterate(const SparseMatrix& m, unsigned num_threads, uint64_t seed,
+                         std::vector<uint64_t>& x, std::vector<uint64_t>& v_last) {
+        const size_t N = m.num_rows;
+        std::mt19937_64 random(seed);
+        std::vector<uint64_t> y(N), v0(N), scratch(m.num_columns);
+        for (uint64_t& word : y) word = random();
+        multiply_symmetric(m, y, v0, scratch, num_threads);
+
+        std::array<std::vector<uint64_t>, 3> v = {v0, std::vector<uint64_t>(N, 0), std::vector<uint64_t>(N, 0)};
+        std::vector<uint64_t> av(N);
+        x.assign(N, 0);
+        std::array<Block, 3> winv{};
+        std::array<Block, 2> vt_a_v{}, vt_a2_v{};
+        std::array<std::array<size_t, 64>, 2> s{};
+        std::iota(s[1].begin(), s[1].end(), 0);
+        size_t dim1 = 64;
+        uint64_t mask1 = ~0ULL;
+
+        // every iteration uses up to 64 dimensions, a breakdown shows up as an iteration count far past N / 63
+        const size_t max_iterations = N / 60 + 100;
+        for (size_t iteration = 0;; ++iteration) {
+            if (iteration > max_iterations) return false;
+            multiply_symmetric(m, v[0], av, scratch, num_threads);
+            vt_a_v[0] = inner_product(v[0], av);
+            vt_a2_v[0] = inner_product(av, av);
+            if (std::all_of(vt_a_v[0].begin(), vt_a_v[0].end(), [](uint64_t w) { return w == 0; })) break;
+
+            const size_t dim0 = find_nonsingular_sub(vt_a_v[0], s[0], s[1], dim1, winv[0]);
+            if (dim0 == 0) return false;
+            uint64_t mask0 = 0;
+            for (size_t i = 0; i < dim0; ++i) mask0 |= 1ULL << s[0][i];
+
+            // x += V_i Winv_i V_i^T V_0
+            multiply_accumulate(v[0], multiply(winv[0], inner_product(v[0], v0)), x);
+
+            // V_{i+1} = A V_i S_i S_i^T + V_i D + V_{i-1} E + V_{i-2} F
+            Block d, e, f, f2;
+            for (size_t i = 0; i < 64; ++i) d[i] = (vt_a2_v[0][i] & mask0) ^ vt_a_v[0][i];
+            d = multiply(winv[0], d);
+            for (size_t i = 0; i < 64; ++i) d[i] ^= 1ULL << i;
+
+            e = multiply(winv[1], vt_a_v[0]);
+            for (uint64_t& word : e) word &= mask0;
+
+            f = multiply(vt_a_v[1], winv[1]);
+            for (size_t i = 0; i < 64; ++i) f[i] ^= 1ULL << i;
+            f = multiply(winv[2], f);
+            for (size_t i = 0; i < 64; ++i) f2[i] = ((vt_a2_v[1][i] & mask1) ^ vt_a_v[1][i]) & mask0;
+            f = multiply(f, f2);
+
+            for (uint64_t& word : av) word &= mask0;
+            multiply_accumulate(v[0], d, av);
+            multiply_accumulate(v[1], e, av);
+            multiply_accumulate(v[2], f, av);
+
+            std::swap(v[2], v[1]);
+            std::swap(v[1], v[0]);
+            std::swap(v[0], av);
+            winv[2] = winv[1];
+            winv[1] = winv[0];
+            vt_a_v[1] = vt_a_v[0];
+            vt_a2_v[1] = vt_a2_v[0];
+            s[1] = s[0];
+            mask1 = mask0;
+            dim1 = dim0;
+        }
+
+        // A x = A y, so x - y is in the null space of A unless the iteration lost dimensions
+        for (size_t i = 0; i < N; ++i) x[i] ^= y[i];
+        v_last = std::move(v[0]);
+        return true;
+    }
+
+    // Null space of A = B^T B is not quite the null space of B. Eliminate B [x | v] over its 128 columns,
+    // the combinations that vanish are the real dependencies.
+    std::vector<std::vector<size_t>> combine(const SparseMatrix& m, const std::vector<uint64_t>& x,
+                                             const std::vector<uint64_t>& v, size_t max_dependencies) {
+        const size_t words = (m.num_columns + 63) / 64;
+        std::vector<std::vector<uint64_t>> image(128, std::vector<uint64_t>(words, 0));
+        for (size_t c = 0; c < m.num_columns; ++c) {
+            uint64_t bx = 0, bv = 0;
+            for (uint32_t i = m.column_start[c]; i < m.column_start[c + 1]; ++i) {
+                bx ^= x[m.column_entries[i]];
+                bv ^= v[m.column_entries[i]];
+            }
+            for (; bx; bx &= bx - 1) image[std::countr_zero(bx)][c / 64] |= 1ULL << (c % 64);
+            for (; bv; bv &= bv - 1) image[64 + std::countr_zero(bv)][c / 64] |= 1ULL << (c % 64);
+        }
+
+        // combination[k] says which of the 128 vectors make up image[k]
+        std::vector<std::array<uint64_t, 2>> combination(128);
+        for (size_t k = 0; k < 128; ++k) combination[k] = {k < 64 ? 1ULL << k : 0, k < 64 ? 0 : 1ULL << (k - 64)};
+        std::vector<uint8_t> pivot(128, 0);
+        for (size_t w = 0; w < words; ++w) {
+            for (size_t bit = 0; bit < 64; ++bit) {
+                const uint64_t mask = 1ULL << bit;
+                size_t p = 0;
+                while (p < 128 && (pivot[p] || !(image[p][w] & mask))) ++p;
+                if (p == 128) continue;
+                pivot[p] = 1;
+                for (size_t k = 0; k < 128; ++k) {
+                    if (k == p || !(image[k][w] & mask)) continue;
+                    for (size_t i = w; i < words; ++i) image[k][i] ^= image[p][i];
+                    combination[k][0] ^= combination[p][0];
+                    combination[k][1] ^= combination[p][1];
+                }
+            }
+        }
+
+        std::vector<std::vector<size_t>> dependencies;
+        for (size_t k = 0; k < 128 && dependencies.size() < max_dependencies; ++k) {
+            if (pivot[k]) continue;
+            std::vector<size_t> dependency;
+            for (size_t r = 0; r < m.num_rows; ++r) {
+                if ((std::popcount(x[r] & combination[k][0]) + std::popcount(v[r] & combination[k][1])) & 1) {
+                    dependency.push_back(r);
+                }
+            }
+            if (!dependency.empty()) dependencies.push_back(std::move(dependency));
+        }
+        return dependencies;
+    }
+}
+
+std::vector<std::vector<size_t>> lanczos_dependencies(const std::vector<std::vector<uint32_t>>& rows,
+                                                      size_t num_columns, size_t max_dependencies,
+                                                      unsigned num_threads) {
+    if (num_threads == 0) num_threads = 1;
+    const Filtered filtered = filter(rows, num_columns);
+    const SparseMatrix& m = filtered.matrix;
+    if (m.num_rows <= m.num_columns) return {};
+
+    std::vector<uint64_t> x, v;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        if (!lanczos_iterate(m, num_threads, std::random_device{}(), x, v)) continue;
+        std::vector<std::vector<size_t>> dependencies = combine(m, x, v, max_dependencies);
+        if (dependencies.empty()) continue;
+        for (auto& dependency : dependencies) {
+            for (size_t& r : dependency) r = filtered.original_row[r];
+        }
+        return dependencies;
+    }
+    return {};
+}
@@ -0,0 +1,16 @@
+#ifndef BLOCKLANCZOS_H
+#define BLOCKLANCZOS_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Montgomery's block Lanczos over GF(2) for the large sparse matrices of the sieve methods.
+// Same input and output as gauss_dependencies in GF2Solver.h. Before the solve, singleton columns and
+// surplus cliques are filtered out. The matrix is kept in compressed row and column form, vectors are
+// blocks of 64 bits per row and the matrix-vector products run on num_threads threads.
+// Returns an empty list if the iteration broke down, the caller can then retry or fall back to Gauss.
+std::vector<std::vector<size_t>> lanczos_dependencies(const std::vector<std::vector<uint32_t>>& rows,
+                                                      size_t num_columns, size_t max_dependencies,
+                                                      unsigned num_threads);
+
+#endif //BLOCKLANCZOS_H
@@ -0,0 +1,191 @@
+#include "BonehDurfee.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+#include "Lattice.h"
+
+namespace {
+    constexpr size_t REDUCED_VECTORS_TRIED = 4;  // resultants of every pair among the shortest vectors
+
+    // (power of x, power of y) -> coefficient
+    using Bivariate = std::map<std::pair<unsigned, unsigned>, mpz_class>;
+
+    Bivariate multiply(const Bivariate& a, const Bivariate& b) {
+        Bivariate product;
+        for (const auto& [ma, ca] : a) {
+            for (const auto& [mb, cb] : b) product[{ma.first + mb.first, ma.second + mb.second}] += ca * cb;
+        }
+        return product;
+    }
+
+    // a(x, y) at a fixed y as a polynomial in x of the given formal degree
+    IntPoly specialize(const Bivariate& a, unsigned long y, unsigned degree) {
+        IntPoly result(degree + 1);
+        mpz_class power;
+        for (const auto& [monomial, c] : a) {
+            mpz_ui_pow_ui(power.get_mpz_t(), y, monomial.second);
+            result[monomial.first] += c * power;
+        }
+        return result;
+    }
+
+    // fraction free Gaussian elimination (Bareiss), every division is exact
+    mpz_class determinant(IntMatrix m) {
+        const size_t size = m.size();
+        mpz_class previous = 1;
+        int sign = 1;
+        for (size_t k = 0; k + 1 < size; ++k) {
+            if (m[k][k] == 0) {
+                size_t pivot = k + 1;
+                while (pivot < size && m[pivot][k] == 0) ++pivot;
+                if (pivot == size) return 0;
+                std::swap(m[k], m[pivot]);
+                sign = -sign;
+            }
+            for (size_t i = k + 1; i < size; ++i) {
+                for (size_t j = k + 1; j < size; ++j) {
+                    m[i][j] = m[i][j] * m[k][k] - m[i][k] * m[k][j];
+                    mpz_divexact(m[i][j].get_mpz_t(), m[i][j].get_mpz_t(), previous.get_mpz_t());
+                }
+            }
+            previous = m[k][k];
+        }
+        return sign * m[size - 1][size - 1];
+    }
+
+    // Sylvester determinant with formal degrees, so it is the specialization of the bivariate resultant
+    // even where leading coefficients vanish
+    mpz_class resultant(const IntPoly& a, const IntPoly& b) {
+        const size_t da = a.size() - 1, db = b.size() - 1, size = da + db;
+        if (size == 0) return 1;
+        IntMatrix sylvester(size, std::vector<mpz_class>(size));
+        for (size_t i = 0; i < db; ++i) {
+            for (size_t j = 0; j <= da; ++j) sylvester[i][i + j] = a[da - j];
+        }
+        for (size_t i = 0; i < da; ++i) {
+            for (size_t j = 0; j <= db; ++j) sylvester[db + i][i + j] = b[db - j];
+        }
+        return determinant(sylvester);
+    }
+
+    // Res_x(a, b) up to a constant factor, from its values at y = 0..D: with the forward differences
+    // D! R(y) = sum over k of (D! / k!) diff^k R(0) y(y-1)...(y-k+1), which stays in the integers
+    IntPoly resultant_in_y(const Bivariate& a, const Bivariate& b) {
+        unsigned dxa = 0, dya = 0, dxb = 0, dyb = 0;
+        for (const auto& [monomial, c] : a) dxa = std::max(dxa, monomial.first), dya = std::max(dya, monomial.second);
+        for (const auto& [monomial, c] : b) dxb = std::max(dxb, monomial.first), dyb = std::max(dyb, monomial.second);
+        const unsigned degree = dya * dxb + dyb * dxa;
+
+        std::vector<mpz_class> differences(degree + 1);
+        for (unsigned y = 0; y <= degree; ++y) differences[y] = resultant(specialize(a, y, dxa), specialize(b, y, dxb));
+        for (unsigned k = 1; k <= degree; ++k) {
+            for (unsigned i = degree; i >= k; --i) differences[i] -= differences[i - 1];
+        }
+        std::vector<mpz_class> scale(degree + 1);   // D! / k!
+        scale[degree] = 1;
+        for (unsigned k = degree; k > 0; --k) scale[k - 1] = scale[k] * k;
+
+        // Horner in the falling factorial basis
+        IntPoly result{differences[degree] * scale[degree]};
+        for (unsigned k = degree; k-- > 0;) {
+            result.push_back(0);
+            for (size_t i = result.size() - 1; i > 0; --i) result[i] = result[i - 1] - k * result[i];
+            result[0] = differences[k] * scale[k] - k * result[0];
+        }
+        mpz_class content = 0;
+        for (const mpz_class& c : result) mpz_gcd(content.get_mpz_t(), content.get_mpz_t(), c.get_mpz_t());
+        if (content > 1) {
+            for (mpz_class& c : result) mpz_divexact(c.get_mpz_t(), c.get_mpz_t(), content.get_mpz_t());
+        }
+        while (!result.empty() && result.back() == 0) result.pop_back();
+        return result;
+    }
+
+    mpz_class power_of_two(double exponent) {
+        mpz_class result;
+        mpz_ui_pow_ui(result.get_mpz_t(), 2, static_cast<unsigned long>(std::ceil(exponent)));
+        return result;
+    }
+}
+
+mpz_class boneh_durfee_factor(const mpz_class& e, const mpz_class& n, double delta, unsigned m) {
+    if (e <= 0 || n < 15 || mpz_even_p(n.get_mpz_t()) || delta <= 0 || delta >= 0.5 || m == 0) return 0;
+    const double bits = static_cast<double>(mpz_sizeinbase(n.get_mpz_t(), 2));
+    // ed > phi(n), so a d below n^delta needs e above about n^(1 - delta)
+    if (static_cast<double>(mpz_sizeinbase(e.get_mpz_t(), 2)) + delta * bits + 1 < bits) return 0;
+    const auto t = static_cast<unsigned>((1 - 2 * delta) * m);
+
+    // |x| = 2k < 2d, |y| = (p + q) / 2 stays below 3/2 sqrt(n) unless p and q are far apart
+    const mpz_class X = power_of_two(delta * bits + 1);
+    mpz_class Y;
+    mpz_sqrt(Y.get_mpz_t(), n.get_mpz_t());
+    Y = 3 * Y / 2;
+    const Bivariate f{{{0, 0}, 1}, {{1, 0}, (n + 1) / 2}, {{1, 1}, 1}};
+
+    // f^k e^(m-k)
+    std::vector<Bivariate> powers(m + 1);
+    Bivariate f_power{{{0, 0}, 1}};
+    mpz_class e_power;
+    for (unsigned k = 0; k <= m; ++k) {
+        mpz_pow_ui(e_power.get_mpz_t(), e.get_mpz_t(), m - k);
+        for (const auto& [monomial, c] : f_power) powers[k][monomial] = c * e_power;
+        f_power = multiply(f_power, f);
+    }
+    std::vector<Bivariate> shifts;
+    auto shift = [&](const Bivariate& a, unsigned i, unsigned j) {
+        Bivariate shifted;
+        for (const auto& [monomial, c] : a) shifted[{monomial.first + i, monomial.second + j}] = c;
+        shifts.push_back(std::move(shifted));
+    };
+    for (unsigned k = 0; k <= m; ++k) {
+        for (unsigned i = 0; i <= m - k; ++i) shift(powers[k], i, 0);
+    }
+    for (unsigned j = 1; j <= t; ++j) {
+        for (unsigned k = 0; k <= m; ++k) shift(powers[k], 0, j);
+    }
+
+    // one column per monomial x^a y^b, scaled by X^a Y^b
+    std::map<std::pair<unsigned, unsigned>, size_t> columns;
+    for (const Bivariate& s : shifts) {
+        for (const auto& [monomial, c] : s) columns.try_emplace(monomial, columns.size());
+    }
+    std::vector<mpz_class> scale(columns.size());
+    mpz_class X_power, Y_power;
+    for (const auto& [monomial, column] : columns) {
+        mpz_pow_ui(X_power.get_mpz_t(), X.get_mpz_t(), monomial.first);
+        mpz_pow_ui(Y_power.get_mpz_t(), Y.get_mpz_t(), monomial.second);
+        scale[column] = X_power * Y_power;
+    }
+    IntMatrix basis(shifts.size(), std::vector<mpz_class>(columns.size()));
+    for (size_t row = 0; row < shifts.size(); ++row) {
+        for (const auto& [monomial, c] : shifts[row]) {
+            const size_t column = columns[monomial];
+            basis[row][column] = c * scale[column];
+        }
+    }
+    lll_reduce(basis);
+
+    // short vectors back to polynomials that vanish at the root over the integers
+    std::vector<Bivariate> reduced(std::min(REDUCED_VECTORS_TRIED, basis.size()));
+    for (size_t row = 0; row < reduced.size(); ++row) {
+        for (const auto& [monomial, column] : columns) {
+            if (basis[row][column] != 0) reduced[row][monomial] = basis[row][column] / scale[column];
+        }
+    }
+    mpz_class sum, discriminant, root;
+    for (size_t i = 0; i < reduced.size(); ++i) {
+        for (size_t j = i + 1; j < reduced.size(); ++j) {
+            for (const mpz_class& y : integer_roots(resultant_in_y(reduced[i], reduced[j]), Y)) {
+                sum = -2 * y;
+                discriminant = sum * sum - 4 * n;
+                if (discriminant < 0 || !mpz_perfect_square_p(discriminant.get_mpz_t())) continue;
+                mpz_sqrt(root.get_mpz_t(), discriminant.get_mpz_t());
+                const mpz_class p = (sum + root) / 2;
+                if (p > 1 && p < n && n % p == 0) return p;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef BONEHDURFEE_H
+#define BONEHDURFEE_H
+#include <gmpxx.h>
+
+constexpr double BONEH_DURFEE_DEFAULT_DELTA = 0.27;
+constexpr unsigned BONEH_DURFEE_DEFAULT_M = 5;
+
+// Boneh and Durfee's lattice attack on RSA keys with d < n^delta, which reaches past Wiener's n^0.25
+// (up to 0.284 for large m). e is assumed about as large as n.
+// ed = 1 + k*phi(n) with phi = n + 1 - (p + q) gives the small root x = 2k, y = -(p + q) / 2 of
+// f(x, y) = 1 + x((n + 1) / 2 + y) mod e. The shifts x^i f^k e^(m-k) and y^j f^k e^(m-k), j <= t =
+// (1 - 2 delta) m, span a lattice whose LLL reduced vectors are polynomials that vanish at the root over
+// the integers. The resultant of two of them in x is a polynomial in y alone, its integer roots are found
+// by Hensel lifting and p + q = -2y gives p.
+// The lattice has (m + 1)(m + 2) / 2 + t(m + 1) rows, larger m reaches closer to the bound but costs
+// far more LLL time. Returns p, or 0 if no root turned up.
+mpz_class boneh_durfee_factor(const mpz_class& e, const mpz_class& n, double delta = BONEH_DURFEE_DEFAULT_DELTA,
+                              unsigned m = BONEH_DURFEE_DEFAULT_M);
+
+#endif //BONEHDURFEE_H
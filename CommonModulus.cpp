@@ -0,0 +1,104 @@
+#include "CommonModulus.h"
+#include <algorithm>
+#include <unordered_map>
+#include "MpzUtils.h"
+#include "SmallExponent.h"
+
+namespace {
+    // base^exponent mod n for negative exponents too, false if base has no inverse
+    bool signed_power(mpz_class& result, const mpz_class& base, const mpz_class& exponent, const mpz_class& n) {
+        if (exponent >= 0) {
+            mpz_powm(result.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), n.get_mpz_t());
+            return true;
+        }
+        if (mpz_invert(result.get_mpz_t(), base.get_mpz_t(), n.get_mpz_t()) == 0) return false;
+        const mpz_class magnitude = -exponent;
+        mpz_powm(result.get_mpz_t(), result.get_mpz_t(), magnitude.get_mpz_t(), n.get_mpz_t());
+        return true;
+    }
+
+    bool encrypts_to(const mpz_class& m, const mpz_class& e, const mpz_class& n, const mpz_class& c) {
+        mpz_class power;
+        mpz_powm(power.get_mpz_t(), m.get_mpz_t(), e.get_mpz_t(), n.get_mpz_t());
+        return power == c % n;
+    }
+
+    // m from m^g, directly for g = 1
+    bool undo_gcd(const mpz_class& g, const mpz_class& power, const mpz_class& n, uint64_t root_multiples, mpz_class& m) {
+        if (g == 1) {
+            m = power;
+            return true;
+        }
+        return g.fits_ulong_p() && small_message_root(power, g.get_ui(), n, root_multiples, m);
+    }
+}
+
+mpz_class combine_common_modulus(const std::vector<mpz_class>& exponents, const std::vector<mpz_class>& ciphertexts,
+                                 const mpz_class& n, mpz_class& power) {
+    if (exponents.empty()) return 0;
+    mpz_class g = exponents[0];
+    mpz_mod(power.get_mpz_t(), ciphertexts[0].get_mpz_t(), n.get_mpz_t());
+    mpz_class gcd, a, b, left, right;
+    for (size_t i = 1; i < exponents.size() && g != 1; ++i) {
+        // a*g + b*e = gcd, nothing new if g already divides e
+        mpz_gcdext(gcd.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t(), g.get_mpz_t(), exponents[i].get_mpz_t());
+        if (gcd == g) continue;
+        if (!signed_power(left, power, a, n) || !signed_power(right, ciphertexts[i], b, n)) return 0;
+        power = left * right % n;
+        g = gcd;
+    }
+    return g;
+}
+
+std::vector<RecoveredMessage> recover_common_modulus(const std::vector<mpz_class>& e, const std::vector<mpz_class>& n,
+                                                     const std::vector<mpz_class>& c, uint64_t root_multiples) {
+    // equal n have equal low words, the few unequal n in a bucket are split apart by comparing them whole
+    std::unordered_map<uint64_t, std::vector<std::vector<size_t>>> index;
+    for (size_t i = 0; i < n.size(); ++i) {
+        std::vector<std::vector<size_t>>& bucket = index[mpz_get_u64(n[i])];
+        auto group = bucket.begin();
+        while (group != bucket.end() && n[group->front()] != n[i]) ++group;
+        if (group == bucket.end()) bucket.push_back({i});
+        else group->push_back(i);
+    }
+
+    std::vector<RecoveredMessage> recovered;
+    std::vector<mpz_class> exponents, ciphertexts;
+    mpz_class power, m;
+    for (const auto& [low_word, bucket] : index) {
+        for (const std::vector<size_t>& group : bucket) {
+            if (group.size() < 2) continue;
+            const mpz_class& modulus = n[group.front()];
+            exponents.clear();
+            ciphertexts.clear();
+            for (size_t i : group) {
+                exponents.push_back(e[i]);
+                ciphertexts.push_back(c[i]);
+            }
+            const mpz_class g = combine_common_modulus(exponents, ciphertexts, modulus, power);
+            bool consistent = g != 0 && undo_gcd(g, power, modulus, root_multiples, m);
+            for (size_t k = 0; consistent && k < group.size(); ++k) consistent = encrypts_to(m, e[group[k]], modulus, c[group[k]]);
+            if (consistent) {
+                recovered.push_back({group, m});
+                continue;
+            }
+
+            // not all the same message, every pair on its own
+            std::vector<bool> done(group.size(), false);
+            for (size_t a = 0; a < group.size(); ++a) {
+                for (size_t b = a + 1; b < group.size(); ++b) {
+                    if (done[a] && done[b]) continue;
+                    const size_t i = group[a], j = group[b];
+                    const mpz_class pair_g = combine_common_modulus({e[i], e[j]}, {c[i], c[j]}, modulus, power);
+                    if (pair_g == 0 || !undo_gcd(pair_g, power, modulus, root_multiples, m)) continue;
+                    if (!encrypts_to(m, e[i], modulus, c[i]) || !encrypts_to(m, e[j], modulus, c[j])) continue;
+                    recovered.push_back({{i, j}, m});
+                    done[a] = done[b] = true;
+                }
+            }
+        }
+    }
+    std::sort(recovered.begin(), recovered.end(),
+              [](const RecoveredMessage& a, const RecoveredMessage& b) { return a.indices.front() < b.indices.front(); });
+    return recovered;
+}
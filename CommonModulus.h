@@ -0,0 +1,28 @@
+#ifndef COMMONMODULUS_H
+#define COMMONMODULUS_H
+#include <cstdint>
+#include <vector>
+#include <gmpxx.h>
+
+// One message encrypted under the same n with several exponents needs no factoring: the extended gcd
+// a*e1 + b*e2 = g gives m^g = c1^a * c2^b mod n, which is m itself when the exponents are coprime.
+// Folding that over a whole group, gcd(g, e) = a*g + b*e with m^gcd = (m^g)^a * c^b, costs one extended
+// gcd and two powers per ciphertext and leaves m^g for the gcd g of all the exponents.
+
+// Returns g and sets power = m^g mod n, or 0 if a ciphertext that needs a negative power has no inverse mod n
+mpz_class combine_common_modulus(const std::vector<mpz_class>& exponents, const std::vector<mpz_class>& ciphertexts,
+                                 const mpz_class& n, mpz_class& power);
+
+struct RecoveredMessage {
+    std::vector<size_t> indices;    // the triples that hold m
+    mpz_class m;
+};
+
+// Groups the (e[i], n[i], c[i]) triples by n through a hash index on the low 64 bits of n and decrypts
+// every group of two or more. A group is first folded as a whole, a leftover g > 1 goes through the
+// integer g-th root with up to root_multiples of n added. If the result doesn't re-encrypt to every c of
+// the group (different messages under one n), every pair of coprime exponents is tried on its own.
+std::vector<RecoveredMessage> recover_common_modulus(const std::vector<mpz_class>& e, const std::vector<mpz_class>& n,
+                                                     const std::vector<mpz_class>& c, uint64_t root_multiples);
+
+#endif //COMMONMODULUS_H
@@ -0,0 +1,129 @@
+#include "Coppersmith.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr size_t REDUCED_VECTORS_TRIED = 3;   // the first row almost always has the root already
+
+    double log2_of(const mpz_class& a) {
+        long exponent;
+        const double mantissa = mpz_get_d_2exp(&exponent, a.get_mpz_t());
+        return std::log2(mantissa) + static_cast<double>(exponent);
+    }
+
+    IntPoly multiply(const IntPoly& a, const IntPoly& b) {
+        IntPoly product(a.size() + b.size() - 1);
+        for (size_t i = 0; i < a.size(); ++i) {
+            for (size_t j = 0; j < b.size(); ++j) product[i + j] += a[i] * b[j];
+        }
+        return product;
+    }
+
+    mpz_class evaluate(const IntPoly& f, const mpz_class& x) {
+        mpz_class value = 0;
+        for (size_t i = f.size(); i-- > 0;) value = value * x + f[i];
+        return value;
+    }
+
+    // The smallest m and t with det(L)^(1/dim) sqrt(dim) < n^(beta m), which makes the first LLL vector
+    // small enough. det(L) = n^(degree m (m + 1) / 2) X^(dim (dim - 1) / 2) for dim = degree m + t.
+    bool lattice_shape(unsigned degree, double log_n, double log_X, double beta, unsigned& m, unsigned& t) {
+        for (m = 1; m <= COPPERSMITH_MAX_M; ++m) {
+            const unsigned t_limit = static_cast<unsigned>(degree * m * (1 / beta - 1)) + degree;
+            for (t = 0; t <= t_limit; ++t) {
+                const double dim = degree * m + t;
+                const double log_det = degree * m * (m + 1) / 2.0 * log_n + dim * (dim - 1) / 2 * log_X;
+                if (log_det / dim + std::log2(dim) / 2 < beta * m * log_n) return true;
+            }
+        }
+        return false;
+    }
+}
+
+std::vector<mpz_class> coppersmith_small_roots(const IntPoly& f, const mpz_class& n, double beta, const mpz_class& X) {
+    std::vector<mpz_class> roots;
+    if (f.size() < 2 || f.back() != 1 || n < 2 || X < 1 || beta <= 0 || beta > 1) return roots;
+    const auto degree = static_cast<unsigned>(f.size() - 1);
+    unsigned m, t;
+    if (!lattice_shape(degree, log2_of(n), log2_of(X), beta, m, t)) return roots;
+
+    // x^j n^(m-i) f^i and x^j f^m, row k has degree k so the basis is triangular
+    std::vector<IntPoly> shifts;
+    IntPoly f_power{1};
+    mpz_class n_power;
+    for (unsigned i = 0; i <= m; ++i) {
+        mpz_pow_ui(n_power.get_mpz_t(), n.get_mpz_t(), m - i);
+        for (unsigned j = 0; j < (i < m ? degree : t); ++j) {
+            IntPoly shifted(j + f_power.size());
+            for (size_t k = 0; k < f_power.size(); ++k) shifted[j + k] = f_power[k] * n_power;
+            shifts.push_back(std::move(shifted));
+        }
+        f_power = multiply(f_power, f);
+    }
+    const size_t dim = shifts.size();
+    std::vector<mpz_class> scale(dim);
+    scale[0] = 1;
+    for (size_t k = 1; k < dim; ++k) scale[k] = scale[k - 1] * X;
+    IntMatrix basis(dim, std::vector<mpz_class>(dim));
+    for (size_t row = 0; row < dim; ++row) {
+        for (size_t k = 0; k < shifts[row].size(); ++k) basis[row][k] = shifts[row][k] * scale[k];
+    }
+    lll_reduce(basis);
+
+    mpz_class divisor;
+    for (size_t row = 0; row < std::min(REDUCED_VECTORS_TRIED, dim); ++row) {
+        IntPoly h(dim);
+        for (size_t k = 0; k < dim; ++k) mpz_divexact(h[k].get_mpz_t(), basis[row][k].get_mpz_t(), scale[k].get_mpz_t());
+        while (!h.empty() && h.back() == 0) h.pop_back();
+        if (h.size() < 2) continue;
+        for (const mpz_class& x : integer_roots(h, X)) {
+            if (std::find(roots.begin(), roots.end(), x) != roots.end()) continue;
+            const mpz_class value = evaluate(f, x);
+            mpz_gcd(divisor.get_mpz_t(), value.get_mpz_t(), n.get_mpz_t());
+            if (divisor > 1) roots.push_back(x);
+        }
+        if (!roots.empty()) break;
+    }
+    return roots;
+}
+
+mpz_class factor_with_high_bits(const mpz_class& n, const mpz_class& high, unsigned long unknown_bits) {
+    if (n < 4 || high < 2) return 0;
+    mpz_class half = 0;
+    if (unknown_bits > 0) mpz_ui_pow_ui(half.get_mpz_t(), 2, unknown_bits - 1);
+    // centred on the middle of the unknown range, so the root is at most half as large
+    const mpz_class middle = high + half;
+    if (half == 0) return n % middle == 0 && middle < n ? middle : mpz_class(0);
+    const IntPoly f{middle % n, 1};
+    mpz_class p;
+    for (const mpz_class& x : coppersmith_small_roots(f, n, log2_of(high) / log2_of(n), half)) {
+        const mpz_class candidate = middle + x;
+        mpz_gcd(p.get_mpz_t(), candidate.get_mpz_t(), n.get_mpz_t());
+        if (p > 1 && p < n) return p;
+    }
+    return 0;
+}
+
+mpz_class factor_with_low_bits(const mpz_class& n, const mpz_class& low, unsigned long known_bits) {
+    if (n < 4 || mpz_even_p(n.get_mpz_t()) || low < 1) return 0;
+    // balanced primes: p has at most half of the bits of n, rounded up
+    const unsigned long bits = mpz_sizeinbase(n.get_mpz_t(), 2), p_bits = (bits + 1) / 2;
+    if (known_bits + 1 >= p_bits) return low > 1 && low < n && n % low == 0 ? low : mpz_class(0);
+    mpz_class half, shift;
+    mpz_ui_pow_ui(half.get_mpz_t(), 2, p_bits - known_bits - 1);
+    mpz_ui_pow_ui(shift.get_mpz_t(), 2, known_bits);
+
+    // p = (x + half) 2^known_bits + low, made monic by the inverse of 2^known_bits mod n
+    mpz_class inverse;
+    if (mpz_invert(inverse.get_mpz_t(), shift.get_mpz_t(), n.get_mpz_t()) == 0) return 0;
+    const IntPoly f{(half + low * inverse) % n, 1};
+    // and no less than n / 2^p_bits
+    const double beta = static_cast<double>(bits - 1 - p_bits) / static_cast<double>(bits);
+    mpz_class p;
+    for (const mpz_class& x : coppersmith_small_roots(f, n, beta, half)) {
+        const mpz_class candidate = (x + half) * shift + low;
+        mpz_gcd(p.get_mpz_t(), candidate.get_mpz_t(), n.get_mpz_t());
+        if (p > 1 && p < n) return p;
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef COPPERSMITH_H
+#define COPPERSMITH_H
+#include <vector>
+#include <gmpxx.h>
+#include "Lattice.h"
+
+// Coppersmith's small roots in Howgrave-Graham's form: the x0 with |x0| <= X and f(x0) = 0 mod b for a monic
+// f and an unknown divisor b >= n^beta of n. Every x^j n^(m-i) f^i (i < m, j < deg f) and x^j f^m (j < t)
+// vanishes at x0 mod b^m. LLL on their coefficients, scaled by X^k, finds a combination small enough that
+// it vanishes at x0 over the integers, and integer_roots finds x0 there.
+// Reaches X up to n^(beta^2 / deg f). m grows with 1 / (that bound - log_n X) and is capped at
+// COPPERSMITH_MAX_M, above which the lattice is too large to reduce in reasonable time.
+// Returns the roots found with gcd(f(x0), n) > 1.
+constexpr unsigned COPPERSMITH_MAX_M = 16;
+std::vector<mpz_class> coppersmith_small_roots(const IntPoly& f, const mpz_class& n, double beta, const mpz_class& X);
+
+// Partial key exposure, both assume p has about half the bits of n and return p or 0.
+// p = high + x with x < 2^unknown_bits, works while fewer than about a quarter of n's bits are unknown
+mpz_class factor_with_high_bits(const mpz_class& n, const mpz_class& high, unsigned long unknown_bits);
+// p = x * 2^known_bits + low, the same quarter of n's bits may be unknown
+mpz_class factor_with_low_bits(const mpz_class& n, const mpz_class& low, unsigned long known_bits);
+
+#endif //COPPERSMITH_H
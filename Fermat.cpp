@@ -0,0 +1,97 @@
+#include "Fermat.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MpzUtils.h"
+
+namespace {
+    constexpr uint64_t BLOCK = 1 << 16;     // consecutive values of a per work item
+    constexpr std::array<unsigned long, 10> MODULI = {64, 63, 65, 11, 17, 19, 23, 29, 31, 37};
+
+    struct FermatShared {
+        const mpz_class& n;
+        const mpz_class& a0;
+        uint64_t max_steps;
+        std::chrono::steady_clock::time_point deadline;
+        // usable[m][a mod MODULI[m]] tells whether a^2 - n can be a square modulo MODULI[m]
+        std::array<std::vector<bool>, MODULI.size()> usable{};
+        std::atomic<uint64_t> next_block{0};
+        std::atomic<bool> done{false};
+        std::mutex mutex{};
+        mpz_class factor{0};
+    };
+
+    void fermat_thread(FermatShared& shared) {
+        const mpz_class& n = shared.n;
+        std::array<unsigned long, MODULI.size()> residue{};
+        mpz_class a, r, b;
+
+        for (uint64_t block = shared.next_block++; !shared.done.load(); block = shared.next_block++) {
+            const uint64_t first = block * BLOCK;
+            if (first >= shared.max_steps || std::chrono::steady_clock::now() > shared.deadline) return;
+            const uint64_t count = std::min(BLOCK, shared.max_steps - first);
+
+            a = shared.a0 + mpz_from_u64(first);
+            for (size_t m = 0; m < MODULI.size(); ++m) residue[m] = mpz_fdiv_ui(a.get_mpz_t(), MODULI[m]);
+
+            for (uint64_t i = 0; i < count; ++i) {
+                bool candidate = true;
+                for (size_t m = 0; m < MODULI.size(); ++m) {
+                    candidate = candidate && shared.usable[m][residue[m]];
+                    if (++residue[m] == MODULI[m]) residue[m] = 0;
+                }
+                if (!candidate) continue;
+
+                mpz_class a_i = a + mpz_from_u64(i);
+                r = a_i * a_i - n;
+                if (!mpz_perfect_square_p(r.get_mpz_t())) continue;
+                mpz_sqrt(b.get_mpz_t(), r.get_mpz_t());
+                mpz_class p = a_i - b;
+                if (p <= 1) continue;
+
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                if (!shared.done) {
+                    shared.factor = p;
+                    shared.done = true;
+                }
+                return;
+            }
+        }
+    }
+}
+
+mpz_class fermat_factor(const mpz_class& n, uint64_t max_steps, unsigned num_threads,
+                        std::chrono::steady_clock::time_point deadline) {
+    if (n < 4) return 0;
+    if (mpz_even_p(n.get_mpz_t())) return 2;
+    if (num_threads == 0) num_threads = 1;
+
+    mpz_class a0;
+    mpz_sqrt(a0.get_mpz_t(), n.get_mpz_t());
+    if (a0 * a0 == n) return a0;
+    ++a0;
+    // a = (p + n / p) / 2 is largest for the smallest odd p, past a = (3 + n / 3) / 2 there is nothing to find
+    const mpz_class a_max = (n + 9) / 6;
+    if (a_max < a0) return 0;
+    const mpz_class steps = a_max - a0 + 1;
+    if (mpz_fits_u64(steps)) max_steps = std::min(max_steps, mpz_get_u64(steps));
+
+    FermatShared shared{n, a0, max_steps, deadline};
+    for (size_t m = 0; m < MODULI.size(); ++m) {
+        const unsigned long modulus = MODULI[m];
+        std::vector<bool> square(modulus, false);
+        for (unsigned long x = 0; x < modulus; ++x) square[x * x % modulus] = true;
+        const unsigned long n_mod = mpz_fdiv_ui(n.get_mpz_t(), modulus);
+        shared.usable[m].resize(modulus);
+        for (unsigned long x = 0; x < modulus; ++x) {
+            shared.usable[m][x] = square[(x * x + modulus - n_mod) % modulus];
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) threads.emplace_back(fermat_thread, std::ref(shared));
+    for (auto& t : threads) t.join();
+    return shared.factor;
+}
@@ -0,0 +1,15 @@
+#ifndef FERMAT_H
+#define FERMAT_H
+#include <chrono>
+#include <cstdint>
+#include <gmpxx.h>
+
+// Fermat's method: looks for a >= ceil(sqrt(n)) with a^2 - n = b^2, then n = (a-b)(a+b).
+// Instant when p and q are close together. Only candidates whose a^2 - n is a square modulo a set of
+// small moduli get the exact test, and the a range is handed to the threads in interleaved blocks.
+// Tries at most max_steps values of a and none past (n + 9) / 6, where the factor would be 3.
+// Returns a non-trivial factor of n or 0, always 0 for a prime n.
+mpz_class fermat_factor(const mpz_class& n, uint64_t max_steps, unsigned num_threads,
+                        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //FERMAT_H
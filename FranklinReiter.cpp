@@ -0,0 +1,57 @@
+#include "FranklinReiter.h"
+#include <stdexcept>
+#include "Polynomial.h"
+
+namespace {
+    // (a*x + b)^e mod n from the binomial theorem, C(e, k) kept exact and updated in place
+    Poly linear_power(const mpz_class& a, const mpz_class& b, unsigned long e, const mpz_class& n) {
+        std::vector<mpz_class> b_powers(e + 1);
+        b_powers[0] = mpz_class(1) % n;
+        for (unsigned long k = 1; k <= e; ++k) b_powers[k] = b_powers[k - 1] * b % n;
+        Poly result(e + 1);
+        mpz_class binomial = 1, a_power = mpz_class(1) % n;
+        for (unsigned long k = 0; k <= e; ++k) {
+            if (k > 0) {
+                mpz_mul_ui(binomial.get_mpz_t(), binomial.get_mpz_t(), e - k + 1);
+                mpz_divexact_ui(binomial.get_mpz_t(), binomial.get_mpz_t(), k);
+                a_power = a_power * a % n;
+            }
+            result[k] = binomial % n * a_power % n * b_powers[e - k] % n;
+        }
+        poly_normalize(result);
+        return result;
+    }
+
+    bool encrypts_to(const mpz_class& m, unsigned long e, const mpz_class& n, const mpz_class& c) {
+        mpz_class power;
+        mpz_powm_ui(power.get_mpz_t(), m.get_mpz_t(), e, n.get_mpz_t());
+        return power == c % n;
+    }
+}
+
+bool franklin_reiter(unsigned long e, const mpz_class& n, const mpz_class& c1, const mpz_class& c2,
+                     const mpz_class& a, const mpz_class& b, mpz_class& m1) {
+    if (e == 0 || n < 2) return false;
+    const mpz_class a_mod = (a % n + n) % n, b_mod = (b % n + n) % n;
+    if (a_mod == 0) return false;
+
+    // x^e - c1
+    Poly first(e + 1);
+    first[0] = (n - c1 % n) % n;
+    first[e] = 1;
+    // (a*x + b)^e - c2
+    Poly second = linear_power(a_mod, b_mod, e, n);
+    second[0] = (second[0] - c2 % n + n) % n;
+
+    Poly gcd;
+    try {
+        gcd = poly_gcd(first, second, n);
+    } catch (const std::domain_error&) {
+        // a leading coefficient that shares a factor with n, the messages stay out of reach that way
+        return false;
+    }
+    if (gcd.size() != 2) return false;
+    // monic x + g0
+    m1 = (n - gcd[0]) % n;
+    return encrypts_to(m1, e, n, c1) && encrypts_to(a_mod * m1 + b_mod, e, n, c2);
+}
@@ -0,0 +1,13 @@
+#ifndef FRANKLINREITER_H
+#define FRANKLINREITER_H
+#include <gmpxx.h>
+
+// Franklin-Reiter: two messages with a known relation m2 = a*m1 + b under the same (e, n) need no
+// factoring. m1 is a root of both x^e - c1 and (a*x + b)^e - c2 mod n, and for almost every pair of
+// messages their gcd is just x - m1. With the half-gcd of poly_gcd that costs O(M(e) log e) instead of
+// the O(e^2) of Euclid, so e = 65537 takes minutes (a 1024 bit n) rather than hours.
+// Returns true and sets m1 if the gcd is linear and its root encrypts to c1 and its image to c2.
+bool franklin_reiter(unsigned long e, const mpz_class& n, const mpz_class& c1, const mpz_class& c2,
+                     const mpz_class& a, const mpz_class& b, mpz_class& m1);
+
+#endif //FRANKLINREITER_H
@@ -0,0 +1,47 @@
+#include "GF2Solver.h"
+#include <cstdint>
+#include <utility>
+
+std::vector<std::vector<size_t>> gauss_dependencies(const std::vector<std::vector<uint32_t>>& rows,
+                                                    size_t num_columns, size_t max_dependencies) {
+    // transposed: one bit row per column of the input, one bit per input row,
+    // so the null space of this matrix is exactly the set of dependencies
+    const size_t num_rows = rows.size();
+    const size_t words = (num_rows + 63) / 64;
+    std::vector<std::vector<uint64_t>> matrix(num_columns, std::vector<uint64_t>(words, 0));
+    for (size_t r = 0; r < num_rows; ++r) {
+        for (uint32_t c : rows[r]) matrix[c][r / 64] ^= 1ULL << (r % 64);
+    }
+
+    // reduced row echelon form, pivot_row[r] is the matrix row whose pivot is bit r
+    std::vector<size_t> pivot_row(num_rows, SIZE_MAX);
+    size_t rank = 0;
+    for (size_t r = 0; r < num_rows && rank < num_columns; ++r) {
+        const size_t word = r / 64;
+        const uint64_t bit = 1ULL << (r % 64);
+        size_t pivot = rank;
+        while (pivot < num_columns && !(matrix[pivot][word] & bit)) ++pivot;
+        if (pivot == num_columns) continue;
+        std::swap(matrix[rank], matrix[pivot]);
+        const std::vector<uint64_t>& pivot_bits = matrix[rank];
+        for (size_t i = 0; i < num_columns; ++i) {
+            if (i == rank || !(matrix[i][word] & bit)) continue;
+            std::vector<uint64_t>& target = matrix[i];
+            for (size_t w = 0; w < words; ++w) target[w] ^= pivot_bits[w];
+        }
+        pivot_row[r] = rank++;
+    }
+
+    // every free bit gives one dependency: itself plus the pivots whose rows contain it
+    std::vector<std::vector<size_t>> dependencies;
+    for (size_t free = 0; free < num_rows && dependencies.size() < max_dependencies; ++free) {
+        if (pivot_row[free] != SIZE_MAX) continue;
+        std::vector<size_t> dependency = {free};
+        for (size_t r = 0; r < num_rows; ++r) {
+            if (pivot_row[r] == SIZE_MAX) continue;
+            if (matrix[pivot_row[r]][free / 64] & (1ULL << (free % 64))) dependency.push_back(r);
+        }
+        dependencies.push_back(std::move(dependency));
+    }
+    return dependencies;
+}
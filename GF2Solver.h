@@ -0,0 +1,14 @@
+#ifndef GF2SOLVER_H
+#define GF2SOLVER_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every row lists the columns in which it has a 1 (the primes with an odd exponent in one relation).
+// A dependency is a set of rows that adds up to zero over GF(2), i.e. a product of relations that is a square.
+
+// Dense Gaussian elimination, returns at most max_dependencies dependencies as lists of row indices
+std::vector<std::vector<size_t>> gauss_dependencies(const std::vector<std::vector<uint32_t>>& rows,
+                                                    size_t num_columns, size_t max_dependencies);
+
+#endif //GF2SOLVER_H
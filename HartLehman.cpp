@@ -0,0 +1,188 @@
+#include "HartLehman.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "PrimeSieve.h"
+
+namespace {
+    constexpr uint64_t HART_MULTIPLIER = 480;   // 480 = 2^5 * 3 * 5 makes s^2 - 480*i*n a square more often
+    constexpr uint32_t TABLE_SIZE = 1 << 16;
+    constexpr uint32_t TINY_PRIME_LIMIT = 256;
+    constexpr size_t RACE_SEGMENT_BYTES = 1024;     // ~4400 numbers of trial division between Hart rounds
+    constexpr uint64_t HART_STEPS_PER_PRIME = 4;    // RSA moduli are balanced, so Hart gets the larger share
+
+    using u128 = unsigned __int128;
+
+    // sqrt(k) for the multipliers of both methods, so the inner loops only do one sqrt(n) multiplication
+    const std::vector<double>& sqrt_table() {
+        static const std::vector<double> table = [] {
+            std::vector<double> t(TABLE_SIZE);
+            for (uint32_t k = 0; k < TABLE_SIZE; ++k) t[k] = std::sqrt(static_cast<double>(k));
+            return t;
+        }();
+        return table;
+    }
+
+    double sqrt_of(uint64_t k) {
+        return k < TABLE_SIZE ? sqrt_table()[k] : std::sqrt(static_cast<double>(k));
+    }
+
+    // squares mod 64 fall on only 12 residues, which rules out most candidates before the sqrt.
+    // More filters (mod 63, 55) cost more in branch misses than the sqrt calls they save.
+    constexpr uint64_t SQUARES_MOD_64 = [] {
+        uint64_t mask = 0;
+        for (uint64_t i = 0; i < 64; ++i) mask |= 1ULL << (i * i % 64);
+        return mask;
+    }();
+
+    bool is_square(uint64_t m, uint64_t& root) {
+        if (!((SQUARES_MOD_64 >> (m & 63)) & 1)) return false;
+        root = static_cast<uint64_t>(std::sqrt(static_cast<double>(m)));
+        while (static_cast<u128>(root) * root > m) --root;
+        while (static_cast<u128>(root + 1) * (root + 1) <= m) ++root;
+        return root * root == m;
+    }
+
+    // ceil(sqrt(x)) from a floating point estimate, fixed up with exact squares
+    uint64_t ceil_sqrt(u128 x, double estimate) {
+        auto s = static_cast<uint64_t>(estimate);
+        while (static_cast<u128>(s) * s < x) ++s;
+        while (s > 0 && static_cast<u128>(s - 1) * (s - 1) >= x) --s;
+        return s;
+    }
+
+    uint64_t mulmod(uint64_t a, uint64_t b, uint64_t n) {
+        return static_cast<uint64_t>(static_cast<u128>(a) * b % n);
+    }
+
+    uint64_t powmod(uint64_t base, uint64_t exponent, uint64_t n) {
+        uint64_t result = 1;
+        base %= n;
+        while (exponent) {
+            if (exponent & 1) result = mulmod(result, base, n);
+            base = mulmod(base, base, n);
+            exponent >>= 1;
+        }
+        return result;
+    }
+
+    uint64_t cube_root(uint64_t n) {
+        auto r = static_cast<uint64_t>(std::cbrt(static_cast<double>(n)));
+        while (static_cast<u128>(r) * r * r > n) --r;
+        while (static_cast<u128>(r + 1) * (r + 1) * (r + 1) <= n) ++r;
+        return r;
+    }
+
+    // Hart steps i in [first, last)
+    uint64_t hart_steps(uint64_t n, uint64_t first, uint64_t last) {
+        const double sqrt_n = std::sqrt(static_cast<double>(n)) * sqrt_of(HART_MULTIPLIER);
+        const uint64_t step = n * HART_MULTIPLIER;     // 480*i*n mod 2^64 is all the loop needs
+        uint64_t kn = step * first;
+        for (uint64_t i = first; i < last; ++i, kn += step) {
+            // sqrt(480*i*n) < 2^48 is off by far less than 1 in a double, so s^2 - 480*i*n is small and comes
+            // out exactly in wrapping 64 bit arithmetic, read as signed it says which way to correct s
+            auto s = static_cast<uint64_t>(sqrt_n * sqrt_of(i)) + 1;
+            uint64_t m = s * s - kn;
+            if (static_cast<int64_t>(m) < 0) {
+                m += 2 * s + 1;
+                ++s;
+            } else if (m >= 2 * s - 1) {
+                m -= 2 * s - 1;
+                --s;
+            }
+            uint64_t t;
+            if (!is_square(m, t)) continue;
+            const uint64_t g = std::gcd(s - t, n);
+            if (g > 1 && g < n) return g;
+        }
+        return 0;
+    }
+
+    // Lehman's search once trial division up to n^1/3 came up empty
+    uint64_t lehman_search(uint64_t n) {
+        const uint64_t cbrt = cube_root(n);
+        const double sqrt_n = std::sqrt(static_cast<double>(n));
+        const double sixth_root = std::sqrt(std::cbrt(static_cast<double>(n)));
+        for (uint64_t k = 1; k <= cbrt; ++k) {
+            const u128 four_kn = static_cast<u128>(n) * k * 4;
+            const double sqrt_four_kn = 2 * sqrt_n * sqrt_of(k);
+            const uint64_t a_min = ceil_sqrt(four_kn, sqrt_four_kn);
+            // +1 absorbs the rounding of the floating point window
+            const auto a_max = static_cast<uint64_t>(sqrt_four_kn + sixth_root / (4 * sqrt_of(k))) + 1;
+            for (uint64_t a = a_min; a <= a_max; ++a) {
+                const auto b2 = static_cast<uint64_t>(static_cast<u128>(a) * a - four_kn);
+                uint64_t b;
+                if (!is_square(b2, b)) continue;
+                const uint64_t g = std::gcd(a + b, n);
+                if (g > 1 && g < n) return g;
+            }
+        }
+        return 0;
+    }
+}
+
+bool is_prime_u64(uint64_t n) {
+    if (n < 2) return false;
+    constexpr uint64_t BASES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (uint64_t p : BASES) {
+        if (n % p == 0) return n == p;
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++s;
+    }
+    for (uint64_t a : BASES) {
+        uint64_t x = powmod(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int i = 1; i < s && composite; ++i) {
+            x = mulmod(x, x, n);
+            if (x == n - 1) composite = false;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+uint64_t hart_one_line(uint64_t n, uint64_t max_iterations) {
+    return hart_steps(n, 1, max_iterations + 1);
+}
+
+uint64_t lehman_factor(uint64_t n) {
+    PrimeSieve sieve(2, cube_root(n));
+    std::vector<uint64_t> primes;
+    while (sieve.next_segment(primes)) {
+        for (uint64_t p : primes) {
+            if (n % p == 0) return p;
+        }
+    }
+    return lehman_search(n);
+}
+
+uint64_t factor_u64(uint64_t n) {
+    if (n < 4 || is_prime_u64(n)) return 0;
+    for (uint64_t p = 2; p < TINY_PRIME_LIMIT; ++p) {
+        if (n % p == 0) return p;
+    }
+    if (uint64_t root; is_square(n, root)) return root;
+
+    // Hart finds balanced factors fast and small ones slowly, trial division the other way round.
+    // Race them: after every sieve segment of trial division, a few Hart steps per prime tried.
+    PrimeSieve sieve(TINY_PRIME_LIMIT, cube_root(n), RACE_SEGMENT_BYTES);
+    std::vector<uint64_t> primes;
+    uint64_t step = 1;
+    while (sieve.next_segment(primes)) {
+        for (uint64_t p : primes) {
+            if (n % p == 0) return p;
+        }
+        const uint64_t last = step + HART_STEPS_PER_PRIME * primes.size();
+        if (uint64_t g = hart_steps(n, step, last); g != 0) return g;
+        step = last;
+    }
+    // Hart usually needs about n^1/3 steps, Lehman is the guarantee
+    if (uint64_t g = hart_steps(n, step, std::max(step, cube_root(n))); g != 0) return g;
+    return lehman_search(n);
+}
@@ -0,0 +1,22 @@
+#ifndef HARTLEHMAN_H
+#define HARTLEHMAN_H
+#include <cstdint>
+
+// Factoring of n < 2^64 on machine words, no GMP and no threads.
+// factor_u64 strips tiny primes, runs Hart's one line factorization for a bounded number of steps and
+// finishes with Lehman's method, which is deterministic in O(n^1/3).
+// Returns a non-trivial factor of n, or 0 for n < 4 and primes.
+uint64_t factor_u64(uint64_t n);
+
+// Hart's one line factorization: s = ceil(sqrt(480*i*n)), if s^2 mod n is a square t^2 then gcd(s - t, n).
+// n must be odd and free of factors below 2^8. Returns 0 if max_iterations steps found nothing.
+uint64_t hart_one_line(uint64_t n, uint64_t max_iterations);
+
+// Lehman: trial division up to n^1/3, then a^2 - 4kn = b^2 for k <= n^1/3 and a in a short window above
+// sqrt(4kn). Finds a factor of every odd composite n that is not a square.
+uint64_t lehman_factor(uint64_t n);
+
+// Deterministic Miller-Rabin, the first twelve primes as bases cover all of 2^64
+bool is_prime_u64(uint64_t n);
+
+#endif //HARTLEHMAN_H
@@ -0,0 +1,255 @@
+#include "Lattice.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr double ETA = 0.51;                    // size reduction bound, a bit above 1/2 for rounding errors
+    constexpr size_t MAX_SIZE_REDUCTION_PASSES = 64;
+    constexpr size_t SWAPS_PER_DIMENSION = 200000;  // floating point runs beyond this are assumed stuck
+    constexpr unsigned FLOATING_ATTEMPTS = 4;       // each with twice the precision of the one before
+    constexpr size_t ROOT_PRIMES = 4;                // small primes whose roots get Hensel lifted
+    constexpr unsigned long FIRST_ROOT_PRIME = 1000;
+
+    mpz_class dot(const std::vector<mpz_class>& a, const std::vector<mpz_class>& b) {
+        mpz_class sum = 0;
+        for (size_t i = 0; i < a.size(); ++i) mpz_addmul(sum.get_mpz_t(), a[i].get_mpz_t(), b[i].get_mpz_t());
+        return sum;
+    }
+
+    void subtract_multiple(std::vector<mpz_class>& a, const std::vector<mpz_class>& b, const mpz_class& q) {
+        for (size_t i = 0; i < a.size(); ++i) mpz_submul(a[i].get_mpz_t(), q.get_mpz_t(), b[i].get_mpz_t());
+    }
+
+    // q = round(x / y) for integers
+    mpz_class round_quotient(const mpz_class& x, const mpz_class& y) {
+        mpz_class q, twice = 2 * x + y;
+        mpz_fdiv_q(q.get_mpz_t(), twice.get_mpz_t(), mpz_class(2 * y).get_mpz_t());
+        return q;
+    }
+
+    // L^2 of Nguyen and Stehle: the Gram matrix is kept exact and updated along with the basis, so every
+    // <b_i, b_j> is exact before it is rounded and nothing cancels, the Cholesky factor r and mu are floating.
+    class FloatingLll {
+    public:
+        FloatingLll(IntMatrix& basis, double delta, mp_bitcnt_t precision)
+            : b(basis), n(basis.size()), precision(precision),
+              delta(delta, precision), gram(n, std::vector<mpz_class>(n)),
+              mu(n, std::vector<mpf_class>(n, mpf_class(0, precision))),
+              r(n, std::vector<mpf_class>(n, mpf_class(0, precision))) {
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j <= i; ++j) gram[i][j] = gram[j][i] = dot(b[i], b[j]);
+            }
+        }
+
+        // false if the floating point data broke down, b is a valid basis of the lattice either way
+        bool run() {
+            size_t swaps = 0;
+            if (gram[0][0] == 0) return false;
+            gram_schmidt(0);
+            for (size_t k = 1; k < n;) {
+                if (!size_reduce(k)) return false;
+                // Lovasz: |b*_k|^2 >= (delta - mu^2) |b*_(k-1)|^2, with r_kk = |b*_k|^2. With b_0..b_(k-1) reduced
+                // the rounding error in r_kk is far below r_(k-1)(k-1), so even a negative r_kk means swap.
+                mpf_class lhs(r[k][k], precision);
+                lhs += mu[k][k - 1] * r[k][k - 1];
+                if (lhs < delta * r[k - 1][k - 1]) {
+                    swap(k);
+                    if (++swaps > SWAPS_PER_DIMENSION * n) return false;
+                    if (k > 1) --k;
+                    else gram_schmidt(0);
+                } else {
+                    ++k;
+                }
+            }
+            return true;
+        }
+
+    private:
+        void swap(size_t k) {
+            std::swap(b[k], b[k - 1]);
+            std::swap(gram[k], gram[k - 1]);
+            for (std::vector<mpz_class>& row : gram) std::swap(row[k], row[k - 1]);
+        }
+
+        // b_k -= q b_j, |b_k - q b_j|^2 = G_kk - 2q G_kj + q^2 G_jj
+        void subtract_row(size_t k, size_t j, const mpz_class& q) {
+            subtract_multiple(b[k], b[j], q);
+            gram[k][k] += q * (q * gram[j][j] - 2 * gram[k][j]);
+            for (size_t i = 0; i < n; ++i) {
+                if (i == k) continue;
+                mpz_submul(gram[k][i].get_mpz_t(), q.get_mpz_t(), gram[j][i].get_mpz_t());
+                gram[i][k] = gram[k][i];
+            }
+        }
+
+        // row k of the Cholesky factor: r_kj = <b_k, b_j> - sum mu_ji r_ki, mu_kj = r_kj / r_jj.
+        // Before b_k is size reduced the sums cancel badly, only the mu_kj that drive the reduction matter then.
+        void gram_schmidt(size_t k) {
+            mpf_class value(0, precision);
+            for (size_t j = 0; j <= k; ++j) {
+                value = gram[k][j];
+                for (size_t i = 0; i < j; ++i) value -= mu[j][i] * r[k][i];
+                r[k][j] = value;
+                if (j < k) mu[k][j] = value / r[j][j];
+            }
+            // j = k left r_kk = |b*_k|^2
+        }
+
+        // b_k -= round(mu_kj) b_j from j = k-1 down, repeated until every |mu_kj| <= ETA (lazy size reduction
+        // of L^2), false if that does not settle
+        bool size_reduce(size_t k) {
+            mpz_class q;
+            mpf_class rounded(0, precision);
+            for (size_t pass = 0; pass < MAX_SIZE_REDUCTION_PASSES; ++pass) {
+                gram_schmidt(k);
+                bool reduced = false;
+                for (size_t j = k; j-- > 0;) {
+                    if (abs(mu[k][j]) <= ETA) continue;
+                    rounded = mu[k][j] + 0.5;
+                    mpf_floor(rounded.get_mpf_t(), rounded.get_mpf_t());
+                    mpz_set_f(q.get_mpz_t(), rounded.get_mpf_t());
+                    subtract_row(k, j, q);
+                    for (size_t i = 0; i < j; ++i) mu[k][i] -= rounded * mu[j][i];
+                    mu[k][j] -= rounded;
+                    reduced = true;
+                }
+                if (!reduced) return true;
+            }
+            return false;
+        }
+
+        IntMatrix& b;
+        const size_t n;
+        const mp_bitcnt_t precision;
+        const mpf_class delta;
+        IntMatrix gram;     // <b_i, b_j>
+        std::vector<std::vector<mpf_class>> mu;
+        std::vector<std::vector<mpf_class>> r;
+    };
+
+    // Cohen, A Course in Computational Algebraic Number Theory, algorithm 2.6.7, with rows 0-based and
+    // d[i] the Gram determinant of the first i rows, lambda[k][j] = d[j+1] mu_kj
+    void integral_lll(IntMatrix& b, double delta) {
+        const size_t n = b.size();
+        if (n < 2) return;
+        // delta as a fraction of integers
+        const mpz_class delta_denominator = 1000;
+        const mpz_class delta_numerator = static_cast<long>(delta * 1000);
+        std::vector<mpz_class> d(n + 1);
+        IntMatrix lambda(n, std::vector<mpz_class>(n));
+        d[0] = 1;
+        d[1] = dot(b[0], b[0]);
+        if (d[1] == 0) throw std::domain_error("lattice basis is linearly dependent");
+
+        auto reduce = [&](size_t k, size_t l) {
+            if (2 * abs(lambda[k][l]) <= d[l + 1]) return;
+            const mpz_class q = round_quotient(lambda[k][l], d[l + 1]);
+            subtract_multiple(b[k], b[l], q);
+            lambda[k][l] -= q * d[l + 1];
+            for (size_t i = 0; i < l; ++i) lambda[k][i] -= q * lambda[l][i];
+        };
+        size_t k_max = 0;
+        auto swap = [&](size_t k) {
+            std::swap(b[k], b[k - 1]);
+            for (size_t j = 0; j + 1 < k; ++j) std::swap(lambda[k][j], lambda[k - 1][j]);
+            const mpz_class l = lambda[k][k - 1];
+            const mpz_class B = (d[k - 1] * d[k + 1] + l * l) / d[k];
+            for (size_t i = k + 1; i <= k_max; ++i) {
+                const mpz_class t = lambda[i][k];
+                lambda[i][k] = (d[k + 1] * lambda[i][k - 1] - l * t) / d[k];
+                lambda[i][k - 1] = (B * t + l * lambda[i][k]) / d[k + 1];
+            }
+            d[k] = B;
+        };
+
+        for (size_t k = 1; k < n;) {
+            if (k > k_max) {
+                k_max = k;
+                for (size_t j = 0; j <= k; ++j) {
+                    mpz_class u = dot(b[k], b[j]);
+                    for (size_t i = 0; i < j; ++i) u = (d[i + 1] * u - lambda[k][i] * lambda[j][i]) / d[i];
+                    if (j < k) lambda[k][j] = u;
+                    else d[k + 1] = u;
+                }
+                if (d[k + 1] == 0) throw std::domain_error("lattice basis is linearly dependent");
+            }
+            reduce(k, k - 1);
+            if (delta_denominator * d[k + 1] * d[k - 1]
+                < delta_numerator * d[k] * d[k] - delta_denominator * lambda[k][k - 1] * lambda[k][k - 1]) {
+                swap(k);
+                if (k > 1) --k;
+            } else {
+                for (size_t l = k - 1; l-- > 0;) reduce(k, l);
+                ++k;
+            }
+        }
+    }
+
+    mpz_class evaluate(const IntPoly& f, const mpz_class& x, const mpz_class& modulus) {
+        mpz_class value = 0;
+        for (size_t i = f.size(); i-- > 0;) {
+            value = value * x + f[i];
+            if (modulus != 0) mpz_mod(value.get_mpz_t(), value.get_mpz_t(), modulus.get_mpz_t());
+        }
+        return value;
+    }
+
+    unsigned long evaluate(const std::vector<unsigned long>& f, unsigned long x, unsigned long prime) {
+        unsigned long value = 0;
+        for (size_t i = f.size(); i-- > 0;) value = (value * x + f[i]) % prime;
+        return value;
+    }
+}
+
+void lll_reduce(IntMatrix& basis, double delta) {
+    if (basis.size() < 2) return;
+    // a run that breaks down leaves a partly reduced basis, the next one picks it up with more precision
+    mp_bitcnt_t precision = std::max<mp_bitcnt_t>(128, 2 * basis.size() + 64);
+    for (unsigned attempt = 0; attempt < FLOATING_ATTEMPTS; ++attempt, precision *= 2) {
+        if (FloatingLll(basis, delta, precision).run()) return;
+    }
+    integral_lll(basis, delta);
+}
+
+std::vector<mpz_class> integer_roots(IntPoly f, const mpz_class& bound) {
+    std::vector<mpz_class> roots;
+    size_t zeros = 0;
+    while (zeros < f.size() && f[zeros] == 0) ++zeros;
+    if (zeros == f.size()) return roots;
+    if (zeros > 0) {
+        roots.emplace_back(0);
+        f.erase(f.begin(), f.begin() + static_cast<std::ptrdiff_t>(zeros));
+    }
+    if (f.size() < 2) return roots;
+    IntPoly derivative(f.size() - 1);
+    for (size_t i = 1; i < f.size(); ++i) derivative[i - 1] = f[i] * i;
+
+    mpz_class prime = FIRST_ROOT_PRIME, root, modulus, value, slope;
+    std::vector<unsigned long> f_small(f.size()), derivative_small(derivative.size());
+    for (size_t tried = 0; tried < ROOT_PRIMES;) {
+        mpz_nextprime(prime.get_mpz_t(), prime.get_mpz_t());
+        const unsigned long l = prime.get_ui();
+        if (mpz_divisible_ui_p(f.back().get_mpz_t(), l)) continue;
+        ++tried;
+        for (size_t i = 0; i < f.size(); ++i) f_small[i] = mpz_fdiv_ui(f[i].get_mpz_t(), l);
+        for (size_t i = 0; i < derivative.size(); ++i) derivative_small[i] = mpz_fdiv_ui(derivative[i].get_mpz_t(), l);
+        for (unsigned long r = 0; r < l; ++r) {
+            if (evaluate(f_small, r, l) != 0 || evaluate(derivative_small, r, l) == 0) continue;
+            root = r;
+            modulus = l;
+            while (modulus <= 2 * bound) {
+                modulus *= modulus;
+                value = evaluate(f, root, modulus);
+                slope = evaluate(derivative, root, modulus);
+                mpz_invert(slope.get_mpz_t(), slope.get_mpz_t(), modulus.get_mpz_t());
+                root -= value * slope;
+                mpz_mod(root.get_mpz_t(), root.get_mpz_t(), modulus.get_mpz_t());
+            }
+            if (2 * root > modulus) root -= modulus;
+            if (abs(root) <= bound && evaluate(f, root, 0) == 0 && std::find(roots.begin(), roots.end(), root) == roots.end()) {
+                roots.push_back(root);
+            }
+        }
+    }
+    return roots;
+}
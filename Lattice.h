@@ -0,0 +1,26 @@
+#ifndef LATTICE_H
+#define LATTICE_H
+#include <vector>
+#include <gmpxx.h>
+
+// Integer lattices given by their basis vectors, one row per vector.
+using IntMatrix = std::vector<std::vector<mpz_class>>;
+
+// LLL reduction of the rows of basis in place, Lovasz condition delta, size reduction |mu| <= 0.51.
+// The basis stays exact in mpz_class, only the Gram-Schmidt data is floating point: mpf_class with a
+// precision that grows with the dimension (as in L^2), so huge entries never overflow and mu stays small.
+// The Gram matrix is exact, so no dot product cancels. A floating point run that breaks down (size reduction
+// that doesn't settle or no progress) is restarted with twice the precision, after a few of those the
+// integral LLL of Cohen, 2.6.7, finishes the job on exact integers only.
+// Throws std::domain_error if the rows are linearly dependent.
+void lll_reduce(IntMatrix& basis, double delta = 0.99);
+
+// Polynomials over the integers, as the short vectors of Coppersmith style lattices give them back:
+// coefficient i belongs to x^i (unlike Poly, nothing is reduced mod n).
+using IntPoly = std::vector<mpz_class>;
+
+// Integer roots with |root| <= bound: simple roots mod a few primes around 1000, Hensel lifted
+// quadratically past 2 bound and checked over the integers. Repeated roots are missed.
+std::vector<mpz_class> integer_roots(IntPoly f, const mpz_class& bound);
+
+#endif //LATTICE_H
@@ -0,0 +1,34 @@
+#ifndef MPZUTILS_H
+#define MPZUTILS_H
+#include <cstdint>
+#include <gmpxx.h>
+
+// unsigned long is only 32 bit on Windows, so 64 bit values go through the limbs directly
+inline uint64_t mpz_get_u64(const mpz_class& x) {
+    if constexpr (GMP_NUMB_BITS >= 64) {
+        return static_cast<uint64_t>(mpz_getlimbn(x.get_mpz_t(), 0));
+    } else {
+        return static_cast<uint64_t>(mpz_getlimbn(x.get_mpz_t(), 0))
+             | static_cast<uint64_t>(mpz_getlimbn(x.get_mpz_t(), 1)) << 32;
+    }
+}
+
+inline mpz_class mpz_from_u64(uint64_t x) {
+    mpz_class result;
+    mpz_import(result.get_mpz_t(), 1, -1, sizeof(x), 0, 0, &x);
+    return result;
+}
+
+inline bool mpz_fits_u64(const mpz_class& x) {
+    return x >= 0 && mpz_sizeinbase(x.get_mpz_t(), 2) <= 64;
+}
+
+inline bool mpz_divisible_u64_p(const mpz_class& n, uint64_t d) {
+    if constexpr (sizeof(unsigned long) >= sizeof(uint64_t)) {
+        return mpz_divisible_ui_p(n.get_mpz_t(), static_cast<unsigned long>(d)) != 0;
+    } else {
+        return mpz_divisible_p(n.get_mpz_t(), mpz_from_u64(d).get_mpz_t()) != 0;
+    }
+}
+
+#endif //MPZUTILS_H
@@ -0,0 +1,141 @@
+#include "PollardPm1.h"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace {
+    constexpr unsigned long D = 2310;           // giant step, 2*3*5*7*11
+    constexpr size_t CHECKPOINT = 256;          // stage 2 primes between two gcds
+
+    // Stage 1 again, one prime power at a time, for the rare case that all factors of n showed up at once
+    mpz_class stage1_backtrack(const mpz_class& n, const mpz_class& base, unsigned long B1,
+                               const std::vector<mpz_class>& primes) {
+        mpz_class H = base, g, H_minus_1;
+        for (const auto& p : primes) {
+            if (p > B1) break;
+            const auto exponent = static_cast<unsigned long>(std::floor(std::log(B1) / std::log(p.get_d())));
+            mpz_class max_pow;
+            mpz_pow_ui(max_pow.get_mpz_t(), p.get_mpz_t(), exponent);
+            mpz_powm(H.get_mpz_t(), H.get_mpz_t(), max_pow.get_mpz_t(), n.get_mpz_t());
+            H_minus_1 = H - 1;
+            mpz_gcd(g.get_mpz_t(), H_minus_1.get_mpz_t(), n.get_mpz_t());
+            if (g == n) return 0;
+            if (g != 1) return g;
+        }
+        return 0;
+    }
+
+    struct Stage2Shared {
+        const mpz_class& n;
+        const mpz_class& H;
+        const std::vector<mpz_class>& baby;     // baby[j] = H^j for j coprime to D
+        const std::vector<unsigned long>& stage2_primes;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<bool> done{false};
+        std::mutex mutex{};
+        mpz_class factor{0};
+    };
+
+    // accumulates H^(kD) - H^j for every prime q = kD - j of [first, last), H^q = 1 mod p makes p divide it
+    void stage2_thread(Stage2Shared& shared, size_t first, size_t last) {
+        const mpz_class& n = shared.n;
+        if (first >= last) return;
+
+        unsigned long k = (shared.stage2_primes[first] + D - 1) / D;
+        mpz_class G, Gk, exponent = mpz_class(k) * D;
+        mpz_powm_ui(G.get_mpz_t(), shared.H.get_mpz_t(), D, n.get_mpz_t());
+        mpz_powm(Gk.get_mpz_t(), shared.H.get_mpz_t(), exponent.get_mpz_t(), n.get_mpz_t());
+
+        mpz_class acc = 1, diff, g;
+        for (size_t chunk = first; chunk < last; chunk += CHECKPOINT) {
+            if (shared.done.load() || std::chrono::steady_clock::now() > shared.deadline) return;
+            const unsigned long k_before = k;
+            const mpz_class Gk_before = Gk;
+            const size_t chunk_end = std::min(last, chunk + CHECKPOINT);
+
+            for (size_t i = chunk; i < chunk_end; ++i) {
+                const unsigned long q = shared.stage2_primes[i];
+                for (; k * D < q; ++k) {
+                    mpz_mul(Gk.get_mpz_t(), Gk.get_mpz_t(), G.get_mpz_t());
+                    mpz_mod(Gk.get_mpz_t(), Gk.get_mpz_t(), n.get_mpz_t());
+                }
+                mpz_sub(diff.get_mpz_t(), Gk.get_mpz_t(), shared.baby[k * D - q].get_mpz_t());
+                mpz_mul(acc.get_mpz_t(), acc.get_mpz_t(), diff.get_mpz_t());
+                mpz_mod(acc.get_mpz_t(), acc.get_mpz_t(), n.get_mpz_t());
+            }
+            mpz_gcd(g.get_mpz_t(), acc.get_mpz_t(), n.get_mpz_t());
+            if (g == 1) continue;
+
+            if (g == n) {
+                // several factors in one chunk, redo it with a gcd per prime
+                k = k_before;
+                Gk = Gk_before;
+                for (size_t i = chunk; i < chunk_end; ++i) {
+                    const unsigned long q = shared.stage2_primes[i];
+                    for (; k * D < q; ++k) {
+                        mpz_mul(Gk.get_mpz_t(), Gk.get_mpz_t(), G.get_mpz_t());
+                        mpz_mod(Gk.get_mpz_t(), Gk.get_mpz_t(), n.get_mpz_t());
+                    }
+                    mpz_sub(diff.get_mpz_t(), Gk.get_mpz_t(), shared.baby[k * D - q].get_mpz_t());
+                    mpz_gcd(g.get_mpz_t(), diff.get_mpz_t(), n.get_mpz_t());
+                    if (g != 1) break;
+                }
+                if (g == n || g == 1) return;
+            }
+
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.done) {
+                shared.factor = g;
+                shared.done = true;
+            }
+            return;
+        }
+    }
+}
+
+mpz_class pollard_pm1(const mpz_class& n, const mpz_class& k_B1, unsigned long B1, unsigned long B2,
+                      const std::vector<mpz_class>& primes, unsigned num_threads,
+                      std::chrono::steady_clock::time_point deadline) {
+    if (n < 4) return 0;
+    if (mpz_even_p(n.get_mpz_t())) return 2;
+    if (num_threads == 0) num_threads = 1;
+
+    // Stage 1: H = a^k_B1
+    const mpz_class base = 3;
+    mpz_class H, g;
+    mpz_powm(H.get_mpz_t(), base.get_mpz_t(), k_B1.get_mpz_t(), n.get_mpz_t());
+    mpz_class H_minus_1 = H - 1;
+    mpz_gcd(g.get_mpz_t(), H_minus_1.get_mpz_t(), n.get_mpz_t());
+    if (g == n) return stage1_backtrack(n, base, B1, primes);
+    if (g != 1) return g;
+
+    // Stage 2: baby steps H^j for every j < D coprime to D, giant steps H^(kD)
+    std::vector<unsigned long> stage2_primes;
+    for (const auto& p : primes) {
+        if (p <= B1) continue;
+        if (p > B2) break;
+        stage2_primes.push_back(p.get_ui());
+    }
+    if (stage2_primes.empty()) return 0;
+
+    std::vector<mpz_class> baby(D);
+    mpz_class H_squared = (H * H) % n;
+    mpz_class current = H;
+    for (unsigned long j = 1; j < D; j += 2) {
+        if (std::gcd(j, D) == 1) baby[j] = current;
+        current = (current * H_squared) % n;
+    }
+
+    Stage2Shared shared{n, H, baby, stage2_primes, deadline};
+    std::vector<std::thread> threads;
+    const size_t per_thread = (stage2_primes.size() + num_threads - 1) / num_threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        const size_t first = std::min(stage2_primes.size(), i * per_thread);
+        const size_t last = std::min(stage2_primes.size(), first + per_thread);
+        threads.emplace_back(stage2_thread, std::ref(shared), first, last);
+    }
+    for (auto& t : threads) t.join();
+    return shared.factor;
+}
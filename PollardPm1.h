@@ -0,0 +1,15 @@
+#ifndef POLLARDPM1_H
+#define POLLARDPM1_H
+#include <chrono>
+#include <vector>
+#include <gmpxx.h>
+
+// Pollard p-1, finds p when p-1 is B1-smooth apart from at most one prime in (B1, B2].
+// Stage 1 raises a base to k_B1, stage 2 walks the primes of (B1, B2] with a baby-step/giant-step
+// continuation split over num_threads. k_B1 and primes are the tables the elliptic curve branch builds.
+// Returns a non-trivial factor of n, or 0 if none was found before the deadline.
+mpz_class pollard_pm1(const mpz_class& n, const mpz_class& k_B1, unsigned long B1, unsigned long B2,
+                      const std::vector<mpz_class>& primes, unsigned num_threads,
+                      std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //POLLARDPM1_H
@@ -0,0 +1,103 @@
+#include "PollardRho.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr unsigned long BATCH = 128;  // differences multiplied together per gcd
+
+    struct RhoShared {
+        const mpz_class& n;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<bool> done{false};
+        std::mutex mutex{};
+        mpz_class factor{0};
+
+        [[nodiscard]] bool stopped() const {
+            return done.load() || std::chrono::steady_clock::now() > deadline;
+        }
+    };
+
+    // y = y^2 + c mod n
+    inline void step(mpz_class& y, const mpz_class& c, const mpz_class& n) {
+        mpz_mul(y.get_mpz_t(), y.get_mpz_t(), y.get_mpz_t());
+        mpz_add(y.get_mpz_t(), y.get_mpz_t(), c.get_mpz_t());
+        mpz_mod(y.get_mpz_t(), y.get_mpz_t(), n.get_mpz_t());
+    }
+
+    // One Brent walk, returns the gcd it ended with: a factor, n if the walk collapsed, 1 if it was stopped
+    mpz_class brent_walk(RhoShared& shared, const mpz_class& c, const mpz_class& x0) {
+        const mpz_class& n = shared.n;
+        mpz_class y = x0, x, ys, diff;
+        mpz_class q = 1, g = 1;
+        unsigned long r = 1;
+
+        while (g == 1) {
+            x = y;
+            for (unsigned long i = 0; i < r; ++i) {
+                step(y, c, n);
+                if ((i & 0xFFFF) == 0xFFFF && shared.stopped()) return 1;
+            }
+            unsigned long k = 0;
+            while (k < r && g == 1) {
+                ys = y;
+                const unsigned long steps = std::min(BATCH, r - k);
+                for (unsigned long i = 0; i < steps; ++i) {
+                    step(y, c, n);
+                    mpz_sub(diff.get_mpz_t(), x.get_mpz_t(), y.get_mpz_t());
+                    mpz_mul(q.get_mpz_t(), q.get_mpz_t(), diff.get_mpz_t());
+                    mpz_mod(q.get_mpz_t(), q.get_mpz_t(), n.get_mpz_t());
+                }
+                mpz_gcd(g.get_mpz_t(), q.get_mpz_t(), n.get_mpz_t());
+                k += steps;
+                if (g == 1 && shared.stopped()) return 1;
+            }
+            r *= 2;
+        }
+
+        if (g == n) {
+            // the batch overshot, redo its steps one gcd at a time
+            do {
+                step(ys, c, n);
+                mpz_sub(diff.get_mpz_t(), x.get_mpz_t(), ys.get_mpz_t());
+                mpz_gcd(g.get_mpz_t(), diff.get_mpz_t(), n.get_mpz_t());
+            } while (g == 1);
+        }
+        return g;
+    }
+
+    void rho_thread(RhoShared& shared, unsigned thread_id, unsigned num_threads) {
+        std::mt19937_64 rng(std::random_device{}() + thread_id * 7919);
+        // c = 0 and c = -2 give degenerate walks, every thread gets its own polynomial
+        for (unsigned long c_value = thread_id + 1; !shared.done.load(); c_value += num_threads) {
+            const mpz_class c = c_value;
+            const mpz_class x0 = mpz_class(static_cast<unsigned long>(rng() >> 1)) % shared.n;
+            mpz_class g = brent_walk(shared, c, x0);
+            if (g == 1) return;
+            if (g == shared.n) continue;
+
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.done) {
+                shared.factor = g;
+                shared.done = true;
+            }
+            return;
+        }
+    }
+}
+
+mpz_class pollard_rho_brent(const mpz_class& n, unsigned num_threads, std::chrono::steady_clock::time_point deadline) {
+    if (n < 4 || mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) return 0;
+    if (mpz_even_p(n.get_mpz_t())) return 2;
+    if (num_threads == 0) num_threads = 1;
+
+    RhoShared shared{n, deadline};
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back(rho_thread, std::ref(shared), i, num_threads);
+    }
+    for (auto& t : threads) t.join();
+    return shared.factor;
+}
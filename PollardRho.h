@@ -0,0 +1,12 @@
+#ifndef POLLARDRHO_H
+#define POLLARDRHO_H
+#include <chrono>
+#include <gmpxx.h>
+
+// Pollard rho with Brent's cycle detection. Every thread walks x -> x^2 + c with its own c and
+// multiplies BATCH differences together before it pays for a gcd with n.
+// Returns a non-trivial factor of n, or 0 if n is prime or the deadline passed first.
+mpz_class pollard_rho_brent(const mpz_class& n, unsigned num_threads,
+                            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //POLLARDRHO_H
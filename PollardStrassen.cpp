@@ -0,0 +1,125 @@
+#include "PollardStrassen.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+#include "MpzUtils.h"
+#include "Polynomial.h"
+
+namespace {
+    constexpr size_t MAX_BITS = 128;            // block starts have to fit in 64 bits
+    constexpr uint64_t FALLBACK_MEMORY = 1ULL << 30;    // where the physical memory can't be queried
+
+    uint64_t physical_memory() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGE_SIZE)
+        const long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && page_size > 0) return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+#endif
+        return FALLBACK_MEMORY;
+    }
+
+    // an mpz_class reduced mod n keeps the allocation of the double length product it came from
+    uint64_t coefficient_bytes(size_t bits) {
+        return 48 + 8 * ((2 * bits + 63) / 64);
+    }
+
+    // the subproduct tree of d points, its log2(d) + 1 levels of about d coefficients each, and the
+    // remainders and Kronecker products on the way down: 100 MB for d = 2^16 at 80 bits
+    uint64_t batch_bytes(uint64_t d, size_t bits) {
+        return d * (std::countr_zero(d) + 8) * coefficient_bytes(bits);
+    }
+
+    struct StrassenShared {
+        const mpz_class& n;
+        const Poly& f;
+        uint64_t d;
+        uint64_t blocks;                        // blocks of d integers up to sqrt(n)
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<uint64_t> next_batch{0};
+        std::atomic<uint64_t> best_batch{UINT64_MAX};   // batches after the first hit can be skipped
+        std::mutex mutex{};
+        mpz_class factor{0};
+    };
+
+    void strassen_thread(StrassenShared& shared) {
+        const mpz_class& n = shared.n;
+        const uint64_t d = shared.d;
+        for (uint64_t batch = shared.next_batch++; batch * d < shared.blocks; batch = shared.next_batch++) {
+            if (batch > shared.best_batch.load() || std::chrono::steady_clock::now() > shared.deadline) return;
+
+            // f(j*d) = (j*d + 1) ... (j*d + d) for the blocks j of this batch
+            const uint64_t first = batch * d;
+            const uint64_t count = std::min(d, shared.blocks - first);
+            std::vector<mpz_class> points(count);
+            for (uint64_t i = 0; i < count; ++i) points[i] = mpz_from_u64((first + i) * d);
+            const std::vector<mpz_class> values = poly_evaluate(shared.f, points, n);
+
+            mpz_class product = 1, g;
+            for (const mpz_class& v : values) product = product * v % n;
+            mpz_gcd(g.get_mpz_t(), product.get_mpz_t(), n.get_mpz_t());
+            if (g == 1) continue;
+
+            // first block with a common factor, its smallest divisor of n is the smallest prime factor
+            for (uint64_t j = 0; j < count; ++j) {
+                mpz_gcd(g.get_mpz_t(), values[j].get_mpz_t(), n.get_mpz_t());
+                if (g == 1) continue;
+                const uint64_t start = (first + j) * d + 1;
+                uint64_t divisor = start;
+                while (divisor < start + d && (divisor < 2 || !mpz_divisible_u64_p(n, divisor))) ++divisor;
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                if (batch < shared.best_batch.load()) {
+                    shared.best_batch = batch;
+                    shared.factor = mpz_from_u64(divisor);
+                }
+                break;
+            }
+            return;
+        }
+    }
+}
+
+StrassenPlan plan_pollard_strassen(const mpz_class& n, unsigned num_threads) {
+    if (num_threads == 0) num_threads = 1;
+    // d about n^1/4, so d blocks of d integers reach sqrt(n)
+    mpz_class root;
+    mpz_sqrt(root.get_mpz_t(), n.get_mpz_t());
+    mpz_class fourth_root;
+    mpz_sqrt(fourth_root.get_mpz_t(), root.get_mpz_t());
+    const size_t bits = mpz_sizeinbase(n.get_mpz_t(), 2);
+    const uint64_t budget = physical_memory() / 2;
+
+    // halve d until f and one batch per thread fit
+    StrassenPlan plan{};
+    for (plan.degree = std::bit_ceil(mpz_get_u64(fourth_root) + 1); ; plan.degree /= 2) {
+        const uint64_t blocks = mpz_get_u64(root / plan.degree) + 1;
+        plan.batches = (blocks + plan.degree - 1) / plan.degree;
+        plan.threads = static_cast<unsigned>(std::min<uint64_t>(num_threads, plan.batches));
+        const uint64_t bytes = plan.degree * coefficient_bytes(bits) + plan.threads * batch_bytes(plan.degree, bits);
+        if (bytes <= budget || plan.degree == 1) return plan;
+    }
+}
+
+mpz_class pollard_strassen(const mpz_class& n, unsigned num_threads, std::chrono::steady_clock::time_point deadline) {
+    if (n < 4 || mpz_sizeinbase(n.get_mpz_t(), 2) > MAX_BITS || mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) return 0;
+
+    const StrassenPlan plan = plan_pollard_strassen(n, num_threads);
+    const uint64_t d = plan.degree;
+    mpz_class root;
+    mpz_sqrt(root.get_mpz_t(), n.get_mpz_t());
+    const uint64_t blocks = mpz_get_u64(root / d) + 1;
+
+    std::vector<mpz_class> roots(d);
+    for (uint64_t i = 0; i < d; ++i) roots[i] = n - mpz_from_u64(i + 1);
+    const Poly f = poly_from_roots(roots, n);
+
+    StrassenShared shared{n, f, d, blocks, deadline};
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < plan.threads; ++i) threads.emplace_back(strassen_thread, std::ref(shared));
+    for (auto& t : threads) t.join();
+    return shared.factor;
+}
@@ -0,0 +1,27 @@
+#ifndef POLLARDSTRASSEN_H
+#define POLLARDSTRASSEN_H
+#include <chrono>
+#include <cstdint>
+#include <gmpxx.h>
+
+// Pollard-Strassen: deterministic factoring in O(n^1/4) polynomial steps.
+// f(x) = (x+1)(x+2)...(x+d) mod n is evaluated at x = 0, d, 2d, ... with a remainder tree, so every
+// value is the product of d consecutive integers and one gcd with n covers the whole block.
+// d is the largest power of two up to n^1/4 whose trees fit in half of the physical memory, so the
+// n^1/4 bound holds as long as memory allows (80 bits with 6 GB, 88 bits with 20 GB), beyond that the
+// number of batches grows as sqrt(n) / d^2. It is slower than SQUFOF or ECM on average, but the worst
+// case is fixed in advance.
+
+// d, the batches and the threads pollard_strassen will use for n
+struct StrassenPlan {
+    uint64_t degree;    // d
+    uint64_t batches;   // rounds of d values of f, 1 while d reaches n^1/4
+    unsigned threads;   // no more than there are batches, a thread holds the trees of one batch
+};
+StrassenPlan plan_pollard_strassen(const mpz_class& n, unsigned num_threads);
+
+// Returns the smallest prime factor of n, or 0 for primes and when the deadline passes.
+mpz_class pollard_strassen(const mpz_class& n, unsigned num_threads,
+                           std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //POLLARDSTRASSEN_H
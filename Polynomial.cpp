@@ -0,0 +1,300 @@
+#include "Polynomial.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+    // below this length of the shorter operand, or of the divisor, the plain quadratic methods are faster
+    constexpr size_t SCHOOLBOOK_LIMIT = 16;
+    // below this length the half-gcd just runs Euclid
+    constexpr size_t HALF_GCD_LIMIT = 64;
+
+    Poly truncate(Poly a, size_t length) {
+        if (a.size() > length) a.resize(length);
+        poly_normalize(a);
+        return a;
+    }
+
+    // coefficients of x^(length-1) * a(1/x)
+    Poly reverse(const Poly& a, size_t length) {
+        Poly result(length);
+        for (size_t i = 0; i < length && i < a.size(); ++i) result[length - 1 - i] = a[i];
+        poly_normalize(result);
+        return result;
+    }
+
+    mpz_class inverse(const mpz_class& a, const mpz_class& n) {
+        mpz_class result;
+        if (mpz_invert(result.get_mpz_t(), a.get_mpz_t(), n.get_mpz_t()) == 0) {
+            throw std::domain_error("leading coefficient is not invertible mod n");
+        }
+        return result;
+    }
+
+    Poly mul_schoolbook(const Poly& a, const Poly& b, const mpz_class& n) {
+        Poly result(a.size() + b.size() - 1, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            for (size_t j = 0; j < b.size(); ++j) {
+                mpz_addmul(result[i + j].get_mpz_t(), a[i].get_mpz_t(), b[j].get_mpz_t());
+            }
+        }
+        for (mpz_class& c : result) mpz_mod(c.get_mpz_t(), c.get_mpz_t(), n.get_mpz_t());
+        poly_normalize(result);
+        return result;
+    }
+
+    // every coefficient gets a slot of whole 64 bit words, the import and export then never shift bits
+    void pack(const Poly& a, size_t slot, mpz_class& packed) {
+        std::vector<uint64_t> words(a.size() * slot, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            mpz_export(&words[i * slot], nullptr, -1, sizeof(uint64_t), 0, 0, a[i].get_mpz_t());
+        }
+        mpz_import(packed.get_mpz_t(), words.size(), -1, sizeof(uint64_t), 0, 0, words.data());
+    }
+
+    Poly mul_kronecker(const Poly& a, const Poly& b, const mpz_class& n) {
+        const size_t bits = 2 * mpz_sizeinbase(n.get_mpz_t(), 2) + std::bit_width(std::min(a.size(), b.size())) + 1;
+        const size_t slot = (bits + 63) / 64;
+        mpz_class A, B;
+        pack(a, slot, A);
+        pack(b, slot, B);
+        const mpz_class C = A * B;
+
+        const size_t length = a.size() + b.size() - 1;
+        std::vector<uint64_t> words(length * slot + 1, 0);
+        mpz_export(words.data(), nullptr, -1, sizeof(uint64_t), 0, 0, C.get_mpz_t());
+        Poly result(length);
+        for (size_t i = 0; i < length; ++i) {
+            mpz_import(result[i].get_mpz_t(), slot, -1, sizeof(uint64_t), 0, 0, &words[i * slot]);
+            mpz_mod(result[i].get_mpz_t(), result[i].get_mpz_t(), n.get_mpz_t());
+        }
+        poly_normalize(result);
+        return result;
+    }
+
+    // 1/f mod x^length, doubling the precision with g = g * (2 - f * g) each round
+    Poly inverse_series(const Poly& f, size_t length, const mpz_class& n) {
+        Poly g = {inverse(f[0], n)};
+        const Poly two = {mpz_class(2) % n};
+        for (size_t precision = 1; precision < length;) {
+            precision = std::min(2 * precision, length);
+            const Poly fg = truncate(poly_mul(truncate(f, precision), g, n), precision);
+            g = truncate(poly_mul(g, poly_sub(two, fg, n), n), precision);
+        }
+        return g;
+    }
+
+    void divrem_schoolbook(const Poly& a, const Poly& b, const mpz_class& n, Poly& quotient, Poly& remainder) {
+        const mpz_class lead_inverse = inverse(b.back(), n);
+        remainder = a;
+        quotient.assign(a.size() - b.size() + 1, 0);
+        for (size_t i = quotient.size(); i-- > 0;) {
+            mpz_class& top = remainder[i + b.size() - 1];
+            if (top == 0) continue;
+            quotient[i] = top * lead_inverse % n;
+            for (size_t j = 0; j < b.size(); ++j) {
+                mpz_submul(remainder[i + j].get_mpz_t(), quotient[i].get_mpz_t(), b[j].get_mpz_t());
+                mpz_mod(remainder[i + j].get_mpz_t(), remainder[i + j].get_mpz_t(), n.get_mpz_t());
+            }
+        }
+        poly_normalize(quotient);
+        poly_normalize(remainder);
+    }
+
+    // levels[0] are the (x - points[i]), every node above is the product of its two children
+    std::vector<std::vector<Poly>> subproduct_tree(const std::vector<mpz_class>& points, const mpz_class& n) {
+        std::vector<std::vector<Poly>> levels(1);
+        for (const mpz_class& p : points) {
+            Poly leaf = {mpz_class(-p), 1};
+            mpz_mod(leaf[0].get_mpz_t(), leaf[0].get_mpz_t(), n.get_mpz_t());
+            levels[0].push_back(std::move(leaf));
+        }
+        while (levels.back().size() > 1) {
+            const std::vector<Poly>& below = levels.back();
+            std::vector<Poly> level((below.size() + 1) / 2);
+            for (size_t i = 0; i < level.size(); ++i) {
+                if (2 * i + 1 < below.size()) level[i] = poly_mul(below[2 * i], below[2 * i + 1], n);
+                else level[i] = below[2 * i];
+            }
+            levels.push_back(std::move(level));
+        }
+        return levels;
+    }
+
+    long degree(const Poly& a) {
+        return static_cast<long>(a.size()) - 1;
+    }
+
+    // a divided by x^k, the low coefficients dropped
+    Poly shift_right(const Poly& a, size_t k) {
+        if (k >= a.size()) return {};
+        return {a.begin() + static_cast<long>(k), a.end()};
+    }
+
+    // [[a, b], [c, d]], the cofactors that take a pair of the remainder sequence further down
+    struct Matrix {
+        Poly a, b, c, d;
+    };
+
+    Matrix identity(const mpz_class& n) {
+        const Poly one = {mpz_class(1) % n};
+        return {one, {}, {}, one};
+    }
+
+    Matrix multiply(const Matrix& s, const Matrix& r, const mpz_class& n) {
+        return {poly_add(poly_mul(s.a, r.a, n), poly_mul(s.b, r.c, n), n), poly_add(poly_mul(s.a, r.b, n), poly_mul(s.b, r.d, n), n),
+                poly_add(poly_mul(s.c, r.a, n), poly_mul(s.d, r.c, n), n), poly_add(poly_mul(s.c, r.b, n), poly_mul(s.d, r.d, n), n)};
+    }
+
+    // (x, y) = m (x, y) for an m already applied to (x / x^k, y / x^k), which left (high_x, high_y): by
+    // linearity only the low k coefficients still have to go through m
+    void apply_low(const Matrix& m, Poly& x, Poly& y, Poly high_x, Poly high_y, size_t k, const mpz_class& n) {
+        x = truncate(std::move(x), k);
+        y = truncate(std::move(y), k);
+        Poly low_x = poly_add(poly_mul(m.a, x, n), poly_mul(m.b, y, n), n);
+        Poly low_y = poly_add(poly_mul(m.c, x, n), poly_mul(m.d, y, n), n);
+        if (!high_x.empty()) high_x.insert(high_x.begin(), k, mpz_class(0));
+        if (!high_y.empty()) high_y.insert(high_y.begin(), k, mpz_class(0));
+        x = poly_add(high_x, low_x, n);
+        y = poly_add(high_y, low_y, n);
+    }
+
+    // (x, y) = (y, x mod y) and m = [[0, 1], [1, -q]] m
+    void euclid_step(Poly& x, Poly& y, Matrix& m, const mpz_class& n) {
+        Poly quotient, remainder;
+        poly_divrem(x, y, n, quotient, remainder);
+        x = std::move(y);
+        y = std::move(remainder);
+        Poly c = poly_sub(m.a, poly_mul(quotient, m.c, n), n);
+        Poly d = poly_sub(m.b, poly_mul(quotient, m.d, n), n);
+        m.a = std::move(m.c);
+        m.b = std::move(m.d);
+        m.c = std::move(c);
+        m.d = std::move(d);
+    }
+
+    // For deg a > deg b takes (a, b) down the remainder sequence to the consecutive remainders with degrees
+    // on both sides of k = ceil(deg a / 2) and returns the matrix that does it. The quotients above x^k only
+    // depend on the coefficients above x^k, so the first half comes from a / x^k and b / x^k, one division
+    // later the second half again from the top halves of what is left.
+    Matrix half_gcd(Poly& a, Poly& b, const mpz_class& n) {
+        const size_t k = a.size() / 2;
+        Matrix m = identity(n);
+        if (degree(b) < static_cast<long>(k)) return m;
+        if (a.size() < HALF_GCD_LIMIT) {
+            while (degree(b) >= static_cast<long>(k)) euclid_step(a, b, m, n);
+            return m;
+        }
+        Poly high_a = shift_right(a, k), high_b = shift_right(b, k);
+        m = half_gcd(high_a, high_b, n);
+        apply_low(m, a, b, std::move(high_a), std::move(high_b), k, n);
+        if (degree(b) < static_cast<long>(k)) return m;
+        euclid_step(a, b, m, n);
+        const size_t shift = 2 * k + 1 - a.size();
+        high_a = shift_right(a, shift);
+        high_b = shift_right(b, shift);
+        const Matrix s = half_gcd(high_a, high_b, n);
+        apply_low(s, a, b, std::move(high_a), std::move(high_b), shift, n);
+        return multiply(s, m, n);
+    }
+}
+
+void poly_normalize(Poly& a) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+Poly poly_add(const Poly& a, const Poly& b, const mpz_class& n) {
+    Poly result(std::max(a.size(), b.size()), 0);
+    for (size_t i = 0; i < result.size(); ++i) {
+        if (i < a.size()) result[i] += a[i];
+        if (i < b.size()) result[i] += b[i];
+        if (result[i] >= n) result[i] -= n;
+    }
+    poly_normalize(result);
+    return result;
+}
+
+Poly poly_sub(const Poly& a, const Poly& b, const mpz_class& n) {
+    Poly result(std::max(a.size(), b.size()), 0);
+    for (size_t i = 0; i < result.size(); ++i) {
+        if (i < a.size()) result[i] += a[i];
+        if (i < b.size()) result[i] -= b[i];
+        if (result[i] < 0) result[i] += n;
+    }
+    poly_normalize(result);
+    return result;
+}
+
+Poly poly_mul(const Poly& a, const Poly& b, const mpz_class& n) {
+    if (a.empty() || b.empty()) return {};
+    if (std::min(a.size(), b.size()) < SCHOOLBOOK_LIMIT) return mul_schoolbook(a, b, n);
+    return mul_kronecker(a, b, n);
+}
+
+void poly_divrem(const Poly& a, const Poly& b, const mpz_class& n, Poly& quotient, Poly& remainder) {
+    if (b.empty()) throw std::domain_error("polynomial division by zero");
+    if (a.size() < b.size()) {
+        quotient.clear();
+        remainder = a;
+        return;
+    }
+    if (b.size() < SCHOOLBOOK_LIMIT) {
+        divrem_schoolbook(a, b, n, quotient, remainder);
+        return;
+    }
+    // rev(a) = rev(q) * rev(b) mod x^(deg a - deg b + 1), and rev(b) starts with the invertible lead of b
+    const size_t length = a.size() - b.size() + 1;
+    const Poly reversed_quotient = truncate(poly_mul(truncate(reverse(a, a.size()), length),
+                                                     inverse_series(reverse(b, b.size()), length, n), n), length);
+    quotient = reverse(reversed_quotient, length);
+    remainder = truncate(poly_sub(a, poly_mul(b, quotient, n), n), b.size() - 1);
+}
+
+Poly poly_rem(const Poly& a, const Poly& b, const mpz_class& n) {
+    Poly quotient, remainder;
+    poly_divrem(a, b, n, quotient, remainder);
+    return remainder;
+}
+
+Poly poly_gcd(Poly a, Poly b, const mpz_class& n) {
+    poly_normalize(a);
+    poly_normalize(b);
+    if (a.size() < b.size()) std::swap(a, b);
+    Poly remainder;
+    while (!b.empty()) {
+        if (a.size() > b.size() && a.size() >= HALF_GCD_LIMIT) {
+            half_gcd(a, b, n);
+            if (b.empty()) break;
+        }
+        remainder = poly_rem(a, b, n);
+        a = std::move(b);
+        b = std::move(remainder);
+    }
+    if (a.empty()) return a;
+    const mpz_class lead_inverse = inverse(a.back(), n);
+    for (mpz_class& c : a) c = c * lead_inverse % n;
+    return a;
+}
+
+Poly poly_from_roots(const std::vector<mpz_class>& roots, const mpz_class& n) {
+    if (roots.empty()) return {mpz_class(1) % n};
+    return subproduct_tree(roots, n).back()[0];
+}
+
+std::vector<mpz_class> poly_evaluate(const Poly& f, const std::vector<mpz_class>& points, const mpz_class& n) {
+    if (points.empty()) return {};
+    const std::vector<std::vector<Poly>> levels = subproduct_tree(points, n);
+    std::vector<Poly> current = {poly_rem(f, levels.back()[0], n)};
+    for (size_t l = levels.size() - 1; l-- > 0;) {
+        const std::vector<Poly>& level = levels[l];
+        std::vector<Poly> next(level.size());
+        for (size_t i = 0; i < level.size(); ++i) next[i] = poly_rem(current[i / 2], level[i], n);
+        current = std::move(next);
+    }
+    std::vector<mpz_class> values(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!current[i].empty()) values[i] = current[i][0];
+    }
+    return values;
+}
@@ -0,0 +1,37 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+#include <vector>
+#include <gmpxx.h>
+
+// Dense polynomials over Z/nZ: coefficient i belongs to x^i, all coefficients are in [0, n) and the
+// highest one is non-zero, so the zero polynomial is empty.
+using Poly = std::vector<mpz_class>;
+
+void poly_normalize(Poly& a);
+Poly poly_add(const Poly& a, const Poly& b, const mpz_class& n);
+Poly poly_sub(const Poly& a, const Poly& b, const mpz_class& n);
+
+// Schoolbook for small operands, Kronecker substitution above: both operands are packed into one
+// integer with slots wide enough for every coefficient of the product, GMP's subquadratic
+// multiplication does the work and the slots are read back mod n.
+Poly poly_mul(const Poly& a, const Poly& b, const mpz_class& n);
+
+// Quotient and remainder by Newton inversion of the reversed divisor, O(M(deg a)).
+// The leading coefficient of b has to be invertible mod n.
+void poly_divrem(const Poly& a, const Poly& b, const mpz_class& n, Poly& quotient, Poly& remainder);
+Poly poly_rem(const Poly& a, const Poly& b, const mpz_class& n);
+
+// Monic gcd of a and b. The half-gcd reaches the middle of the remainder sequence from the top halves of
+// the coefficients alone, recursively, so only the quotients and a 2x2 matrix of cofactors are formed on
+// the way: O(M(d) log d) for degree d instead of the O(d^2) of Euclid. Every leading coefficient met has
+// to be invertible mod n, which it is unless it shares a factor with n.
+Poly poly_gcd(Poly a, Poly b, const mpz_class& n);
+
+// (x - roots[0]) * ... * (x - roots[k-1]) through a product tree
+Poly poly_from_roots(const std::vector<mpz_class>& roots, const mpz_class& n);
+
+// f(points[i]) mod n for every point: f is reduced down the subproduct tree of the (x - points[i]),
+// O(M(k) log k) for k points instead of k Horner evaluations.
+std::vector<mpz_class> poly_evaluate(const Poly& f, const std::vector<mpz_class>& points, const mpz_class& n);
+
+#endif //POLYNOMIAL_H
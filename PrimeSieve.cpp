@@ -0,0 +1,126 @@
+#include "PrimeSieve.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+    constexpr uint64_t WHEEL = 210;
+    constexpr size_t SLOTS = 48;
+
+    struct Wheel {
+        std::array<uint8_t, SLOTS> residue{};      // the residues mod 210 coprime to 210
+        std::array<uint8_t, SLOTS> gap{};          // distance to the next residue
+        std::array<uint8_t, WHEEL> slot{};         // residue -> slot, only valid for coprime residues
+        constexpr Wheel() {
+            size_t s = 0;
+            for (uint8_t r = 1; r < WHEEL; ++r) {
+                if (r % 2 && r % 3 && r % 5 && r % 7) {
+                    residue[s] = r;
+                    slot[r] = static_cast<uint8_t>(s);
+                    ++s;
+                }
+            }
+            for (s = 0; s < SLOTS; ++s) {
+                gap[s] = static_cast<uint8_t>((s + 1 < SLOTS ? residue[s + 1] : WHEEL + 1) - residue[s]);
+            }
+        }
+    };
+    constexpr Wheel wheel;
+
+    // Sieving primes >= 11 in tiers, so small ranges don't pay for the table of the largest one.
+    // Every tier is built once and never changes afterwards, sieves in other threads can keep pointers to it.
+    constexpr std::array<uint32_t, 4> TIER_LIMITS = {1u << 13, 1u << 17, 1u << 21, 1u << 25};
+    std::array<std::vector<uint32_t>, TIER_LIMITS.size()> tiers;
+    std::array<std::once_flag, TIER_LIMITS.size()> tier_flags;
+
+    const std::vector<uint32_t>& sieving_primes(uint64_t sqrt_end) {
+        size_t t = 0;
+        while (TIER_LIMITS[t] < sqrt_end) {
+            if (++t == TIER_LIMITS.size()) throw std::out_of_range("PrimeSieve range exceeds PrimeSieve::LIMIT");
+        }
+        std::call_once(tier_flags[t], [t] {
+            const uint32_t limit = TIER_LIMITS[t];
+            std::vector<bool> is_prime(limit + 1, true);
+            for (uint32_t i = 2; i * i <= limit; ++i) {
+                if (is_prime[i]) {
+                    for (uint32_t j = i * i; j <= limit; j += i) is_prime[j] = false;
+                }
+            }
+            for (uint32_t i = 11; i <= limit; ++i) {
+                if (is_prime[i]) tiers[t].push_back(i);
+            }
+        });
+        return tiers[t];
+    }
+}
+
+PrimeSieve::PrimeSieve(uint64_t start, uint64_t end, size_t segment_bytes)
+    : start(start), end(end), low(start / WHEEL * WHEEL),
+      segment_slots(std::max<size_t>(segment_bytes / SLOTS, 1) * SLOTS), segment(segment_slots) {
+    if (end > LIMIT) throw std::out_of_range("PrimeSieve range exceeds PrimeSieve::LIMIT");
+    auto sqrt_end = static_cast<uint64_t>(std::sqrt(static_cast<double>(end)));
+    while (sqrt_end * sqrt_end > end) --sqrt_end;
+    while ((sqrt_end + 1) * (sqrt_end + 1) <= end) ++sqrt_end;
+    base_primes = &sieving_primes(sqrt_end);
+    const size_t needed = std::upper_bound(base_primes->begin(), base_primes->end(), sqrt_end) - base_primes->begin();
+    next_multiple.resize(needed);
+    wheel_index.resize(needed);
+}
+
+// Sets up the first multiple inside the current segment for every prime that starts to matter below high
+void PrimeSieve::activate_primes(uint64_t high) {
+    while (active < next_multiple.size()) {
+        const uint64_t p = (*base_primes)[active];
+        if (p * p >= high) break;
+        // smallest k >= p with p*k >= low and k coprime to 210, smaller multiples are crossed off by smaller primes
+        uint64_t k = std::max(p, (low + p - 1) / p);
+        while (std::gcd(k, WHEEL) != 1) ++k;
+        next_multiple[active] = p * k;
+        wheel_index[active] = wheel.slot[k % WHEEL];
+        ++active;
+    }
+}
+
+bool PrimeSieve::next_segment(std::vector<uint64_t>& primes) {
+    primes.clear();
+    if (low > end) return false;
+
+    // 2, 3, 5 and 7 are not on the wheel
+    if (low < WHEEL) {
+        for (uint64_t p : {2, 3, 5, 7}) {
+            if (p >= start && p <= end) primes.push_back(p);
+        }
+    }
+
+    const uint64_t high = low + segment_slots / SLOTS * WHEEL;
+    activate_primes(high);
+
+    std::fill(segment.begin(), segment.end(), 1);
+    uint8_t* const seg = segment.data();
+    for (size_t i = 0; i < active; ++i) {
+        const uint64_t p = (*base_primes)[i];
+        uint64_t m = next_multiple[i];
+        size_t w = wheel_index[i];
+        while (m < high) {
+            const uint64_t pos = m - low;
+            seg[pos / WHEEL * SLOTS + wheel.slot[pos % WHEEL]] = 0;
+            m += p * wheel.gap[w];
+            if (++w == SLOTS) w = 0;
+        }
+        next_multiple[i] = m;
+        wheel_index[i] = static_cast<uint8_t>(w);
+    }
+
+    for (size_t s = 0; s < segment_slots; ++s) {
+        if (!seg[s]) continue;
+        const uint64_t v = low + s / SLOTS * WHEEL + wheel.residue[s % SLOTS];
+        if (v > end) break;
+        if (v >= start && v > 1) primes.push_back(v);
+    }
+
+    low = high;
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef PRIMESIEVE_H
+#define PRIMESIEVE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Segmented sieve of Eratosthenes on a mod-210 wheel.
+// Only the 48 residues coprime to 2*3*5*7 are stored (one byte each), so a segment
+// of 32 KB covers ~143000 numbers and stays in L1 while every sieving prime walks it.
+class PrimeSieve {
+public:
+    // Largest supported end, the sieving primes up to sqrt(LIMIT) are shared between all sieves
+    static constexpr uint64_t LIMIT = 1ULL << 50;
+
+    PrimeSieve(uint64_t start, uint64_t end, size_t segment_bytes = 32768);
+    // Replaces primes with the primes of the next segment, false once [start, end] is exhausted
+    bool next_segment(std::vector<uint64_t>& primes);
+private:
+    void activate_primes(uint64_t high);
+
+    uint64_t start;
+    uint64_t end;
+    uint64_t low;           // first number of the current segment, always a multiple of 210
+    size_t segment_slots;   // wheel slots per segment, multiple of 48
+    std::vector<uint8_t> segment;
+
+    const std::vector<uint32_t>* base_primes;   // sieving primes >= 11
+    size_t active = 0;                          // base primes with p*p below the current segment end
+    std::vector<uint64_t> next_multiple;
+    std::vector<uint8_t> wheel_index;           // wheel slot of next_multiple / p
+};
+
+#endif //PRIMESIEVE_H
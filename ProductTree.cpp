@@ -0,0 +1,80 @@
+#include "ProductTree.h"
+
+ProductTree::ProductTree(std::vector<mpz_class> leaves) {
+    if (leaves.empty()) leaves.emplace_back(1);
+    levels.push_back(std::move(leaves));
+    while (levels.back().size() > 1) {
+        const std::vector<mpz_class>& below = levels.back();
+        std::vector<mpz_class> level((below.size() + 1) / 2);
+        for (size_t i = 0; i < level.size(); ++i) {
+            if (2 * i + 1 < below.size()) level[i] = below[2 * i] * below[2 * i + 1];
+            else level[i] = below[2 * i];
+        }
+        levels.push_back(std::move(level));
+    }
+}
+
+const mpz_class& ProductTree::root() const {
+    return levels.back()[0];
+}
+
+size_t ProductTree::size() const {
+    return levels[0].size();
+}
+
+const mpz_class& ProductTree::leaf(size_t i) const {
+    return levels[0][i];
+}
+
+std::vector<mpz_class> ProductTree::remainders(const mpz_class& x) const {
+    std::vector<mpz_class> current(1);
+    mpz_mod(current[0].get_mpz_t(), x.get_mpz_t(), root().get_mpz_t());
+    for (size_t l = levels.size() - 1; l-- > 0;) {
+        const std::vector<mpz_class>& level = levels[l];
+        std::vector<mpz_class> next(level.size());
+        for (size_t i = 0; i < level.size(); ++i) {
+            mpz_mod(next[i].get_mpz_t(), current[i / 2].get_mpz_t(), level[i].get_mpz_t());
+        }
+        current = std::move(next);
+    }
+    return current;
+}
+
+std::vector<mpz_class> ProductTree::remainders_squared(const mpz_class& x) const {
+    std::vector<mpz_class> current(1);
+    mpz_class square = root() * root();
+    mpz_mod(current[0].get_mpz_t(), x.get_mpz_t(), square.get_mpz_t());
+    for (size_t l = levels.size() - 1; l-- > 0;) {
+        const std::vector<mpz_class>& level = levels[l];
+        std::vector<mpz_class> next(level.size());
+        for (size_t i = 0; i < level.size(); ++i) {
+            mpz_mul(square.get_mpz_t(), level[i].get_mpz_t(), level[i].get_mpz_t());
+            mpz_mod(next[i].get_mpz_t(), current[i / 2].get_mpz_t(), square.get_mpz_t());
+        }
+        current = std::move(next);
+    }
+    return current;
+}
+
+std::optional<mpz_class> ProductTree::chinese_remainder(const std::vector<mpz_class>& residues) const {
+    // root / leaf(i) mod leaf(i) = (root mod leaf(i)^2) / leaf(i)
+    std::vector<mpz_class> current = remainders_squared(root());
+    for (size_t i = 0; i < current.size(); ++i) {
+        mpz_divexact(current[i].get_mpz_t(), current[i].get_mpz_t(), leaf(i).get_mpz_t());
+        if (mpz_invert(current[i].get_mpz_t(), current[i].get_mpz_t(), leaf(i).get_mpz_t()) == 0) return std::nullopt;
+        current[i] *= residues[i];
+        mpz_mod(current[i].get_mpz_t(), current[i].get_mpz_t(), leaf(i).get_mpz_t());
+    }
+    // sum of current[i] * root / leaf(i): a node is left * (right product) + right * (left product)
+    for (size_t l = 0; l + 1 < levels.size(); ++l) {
+        const std::vector<mpz_class>& level = levels[l];
+        std::vector<mpz_class> next((level.size() + 1) / 2);
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (2 * i + 1 < level.size()) next[i] = current[2 * i] * level[2 * i + 1] + current[2 * i + 1] * level[2 * i];
+            else next[i] = current[2 * i];
+        }
+        current = std::move(next);
+    }
+    mpz_mod(current[0].get_mpz_t(), current[0].get_mpz_t(), root().get_mpz_t());
+    return current[0];
+}
@@ -0,0 +1,28 @@
+#ifndef PRODUCTTREE_H
+#define PRODUCTTREE_H
+#include <optional>
+#include <vector>
+#include <gmpxx.h>
+
+// Binary product tree: levels[0] holds the leaves, every node above is the product of its two children.
+// Reducing a number down the tree gives its residue modulo every leaf with a handful of large
+// divisions instead of one multi-limb reduction per leaf.
+class ProductTree {
+public:
+    explicit ProductTree(std::vector<mpz_class> leaves);
+    [[nodiscard]] const mpz_class& root() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] const mpz_class& leaf(size_t i) const;
+    // x mod leaf(i) for every leaf
+    [[nodiscard]] std::vector<mpz_class> remainders(const mpz_class& x) const;
+    // x mod leaf(i)^2 for every leaf, the squares of the nodes are formed on the way down
+    [[nodiscard]] std::vector<mpz_class> remainders_squared(const mpz_class& x) const;
+    // The x in [0, root()) with x = residues[i] mod leaf(i), or nothing if two leaves share a factor.
+    // Every root() / leaf(i) mod leaf(i) comes out of one remainders_squared(root()), the weighted sum of
+    // the root() / leaf(i) is then built back up the tree, so no inverse of anything larger than a leaf.
+    [[nodiscard]] std::optional<mpz_class> chinese_remainder(const std::vector<mpz_class>& residues) const;
+private:
+    std::vector<std::vector<mpz_class>> levels;
+};
+
+#endif //PRODUCTTREE_H
@@ -0,0 +1,689 @@
+#include "QuadraticSieve.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "BlockLanczos.h"
+#include "GF2Solver.h"
+#include "MpzUtils.h"
+#include "PollardRho.h"
+
+namespace {
+    constexpr uint32_t BLOCK_SIZE = 32768;      // sieve bytes per block, one block stays in L1
+    constexpr uint32_t SMALL_PRIME = 30;        // primes below this are not sieved, only trial divided
+    constexpr size_t EXTRA_RELATIONS = 64;      // relations beyond the number of columns
+    constexpr uint32_t UNUSED = UINT32_MAX;     // root marker for primes that are not sieved
+    constexpr size_t LANCZOS_MIN_ROWS = 1000;   // dense Gauss is cubic, above this block Lanczos takes over
+    constexpr size_t DOUBLE_LARGE_MIN_DIGITS = 50;  // below this the extra cofactor splitting does not pay off
+    constexpr double DOUBLE_LARGE_EXPONENT = 1.8;   // cofactors up to large_prime_bound^1.8 are split
+    constexpr size_t STORE_MIN_DIGITS = 60;     // from here on relations are streamed to disk for resuming
+
+    struct Params {
+        unsigned digits;
+        uint32_t fb_size;       // primes in the factor base
+        uint32_t blocks;        // M = blocks * BLOCK_SIZE, the interval is [-M, M)
+        uint32_t lp_mult;       // large prime bound = lp_mult * largest factor base prime
+    };
+    constexpr Params PARAMS[] = {
+        {20, 100, 1, 30}, {25, 150, 1, 30}, {30, 200, 1, 40}, {35, 300, 1, 40},
+        {40, 500, 1, 50}, {45, 800, 1, 50}, {50, 1300, 2, 60}, {55, 2000, 2, 70},
+        {60, 3000, 3, 80}, {65, 4500, 4, 90}, {70, 6500, 5, 100}, {75, 9000, 6, 100},
+        {80, 13000, 8, 110}, {85, 18000, 10, 120}, {90, 26000, 12, 120}, {95, 38000, 14, 130},
+        {100, 52000, 16, 140},
+    };
+
+    Params choose_params(const mpz_class& n) {
+        const size_t digits = mpz_sizeinbase(n.get_mpz_t(), 10);
+        Params params = PARAMS[0];
+        for (const Params& p : PARAMS) {
+            if (p.digits <= digits) params = p;
+        }
+        return params;
+    }
+
+    uint32_t powmod(uint64_t base, uint64_t exponent, uint32_t p) {
+        uint64_t result = 1;
+        base %= p;
+        while (exponent) {
+            if (exponent & 1) result = result * base % p;
+            base = base * base % p;
+            exponent >>= 1;
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    uint32_t inverse_mod(uint32_t a, uint32_t p) {
+        return powmod(a, p - 2, p);
+    }
+
+    // Tonelli-Shanks, a has to be a square mod the odd prime p
+    uint32_t sqrt_mod(uint32_t a, uint32_t p) {
+        a %= p;
+        if (a == 0) return 0;
+        if (p % 4 == 3) return powmod(a, (p + 1) / 4, p);
+        uint32_t q = p - 1, s = 0;
+        while (q % 2 == 0) { q /= 2; ++s; }
+        uint32_t z = 2;
+        while (powmod(z, (p - 1) / 2, p) != p - 1) ++z;
+        uint64_t m = s, c = powmod(z, q, p), t = powmod(a, q, p), r = powmod(a, (q + 1) / 2, p);
+        while (t != 1) {
+            uint64_t i = 0, t2 = t;
+            while (t2 != 1) { t2 = t2 * t2 % p; ++i; }
+            uint64_t b = c;
+            for (uint64_t j = 0; j + 1 < m - i; ++j) b = b * b % p;
+            m = i;
+            c = b * b % p;
+            t = t * c % p;
+            r = r * b % p;
+        }
+        return static_cast<uint32_t>(r);
+    }
+
+    std::vector<uint32_t> small_primes(uint32_t limit) {
+        std::vector<bool> is_prime(limit + 1, true);
+        std::vector<uint32_t> primes;
+        for (uint32_t i = 2; i <= limit; ++i) {
+            if (!is_prime[i]) continue;
+            primes.push_back(i);
+            for (uint64_t j = static_cast<uint64_t>(i) * i; j <= limit; j += i) is_prime[j] = false;
+        }
+        return primes;
+    }
+
+    // Knuth-Schroeppel: the multiplier k that makes the most small primes quadratic residues of k*n
+    unsigned long choose_multiplier(const mpz_class& n) {
+        constexpr unsigned long CANDIDATES[] = {1, 3, 5, 7, 11, 13, 15, 17, 19, 21, 23, 29, 31, 33, 35, 37,
+                                                39, 41, 43, 47, 51, 53, 55, 57, 59, 61, 65, 67, 69, 71, 73};
+        const std::vector<uint32_t> primes = small_primes(2000);
+        unsigned long best = 1;
+        double best_score = 1e300;
+        for (unsigned long k : CANDIDATES) {
+            const mpz_class kn = n * k;
+            double score = 0.5 * std::log(static_cast<double>(k));
+            switch (mpz_fdiv_ui(kn.get_mpz_t(), 8)) {
+                case 1: score -= 2 * std::log(2.0); break;
+                case 5: score -= std::log(2.0); break;
+                case 3: case 7: score -= 0.5 * std::log(2.0); break;
+                default: break;
+            }
+            for (uint32_t p : primes) {
+                if (p == 2) continue;
+                if (k % p == 0) score -= std::log(static_cast<double>(p)) / p;
+                else if (powmod(mpz_fdiv_ui(kn.get_mpz_t(), p), (p - 1) / 2, p) == 1)
+                    score -= 2 * std::log(static_cast<double>(p)) / (p - 1);
+            }
+            if (score < best_score) {
+                best_score = score;
+                best = k;
+            }
+        }
+        return best;
+    }
+
+    struct FactorBase {
+        std::vector<uint32_t> prime;
+        std::vector<uint32_t> sqrt_kn;      // sqrt(k*n) mod prime
+        std::vector<uint8_t> logp;
+        size_t first_sieved = 0;            // index of the first prime >= SMALL_PRIME
+    };
+
+    struct Relation {
+        mpz_class Y;                        // A*x + B, Y^2 = product of the factors mod n
+        std::vector<uint32_t> factors;      // column of every prime factor with multiplicity, 0 is -1
+        uint64_t large_primes[2] = {1, 1};  // 1 for unused slots, {1, 1} is a full relation
+
+        [[nodiscard]] bool full() const { return large_primes[0] == 1 && large_primes[1] == 1; }
+    };
+
+    // one relation per line: Y in hex, both large primes, then the factor columns
+    std::string relation_line(const Relation& relation) {
+        std::string line = relation.Y.get_str(16) + ' ' + std::to_string(relation.large_primes[0]) + ' '
+                         + std::to_string(relation.large_primes[1]);
+        for (uint32_t c : relation.factors) line += ' ' + std::to_string(c);
+        return line + '\n';
+    }
+
+    // Y^2 = A * Q(x) mod kn, so Y^2 mod n has to equal the product of everything the relation lists
+    bool parse_relation(const std::string& line, const mpz_class& n, const std::vector<uint32_t>& primes,
+                        Relation& relation) {
+        const size_t space = line.find(' ');
+        if (space == std::string::npos || relation.Y.set_str(line.substr(0, space), 16) != 0) return false;
+        char* cursor = const_cast<char*>(line.c_str()) + space;
+        char* end;
+        relation.large_primes[0] = std::strtoull(cursor, &end, 10);
+        relation.large_primes[1] = std::strtoull(end, &cursor, 10);
+        if (end == cursor) return false;
+        mpz_class product = static_cast<unsigned long>(1);
+        product = product * mpz_from_u64(relation.large_primes[0]) * mpz_from_u64(relation.large_primes[1]);
+        relation.factors.clear();
+        for (unsigned long c = std::strtoul(cursor, &end, 10); end != cursor; c = std::strtoul(cursor, &end, 10)) {
+            cursor = end;
+            if (c > primes.size()) return false;
+            relation.factors.push_back(static_cast<uint32_t>(c));
+            if (c == 0) product = -product;
+            else product *= primes[c - 1];
+        }
+        mpz_class square = relation.Y * relation.Y - product;
+        return mpz_divisible_p(square.get_mpz_t(), n.get_mpz_t()) != 0;
+    }
+
+    // Brent's rho on a composite cofactor below 2^64, returns a proper divisor or 1
+    uint64_t split_cofactor(uint64_t n) {
+        auto mulmod = [n](uint64_t a, uint64_t b) { return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % n); };
+        for (uint64_t c = 1; c < 16; ++c) {
+            uint64_t x = 2, y = 2, ys = 2, q = 1, g = 1;
+            for (uint64_t r = 1; g == 1 && r < (1ULL << 20); r *= 2) {
+                x = y;
+                for (uint64_t i = 0; i < r; ++i) y = mulmod(y, y) + c;
+                for (uint64_t k = 0; k < r && g == 1; k += 64) {
+                    ys = y;
+                    for (uint64_t i = 0; i < 64 && i < r - k; ++i) {
+                        y = mulmod(y, y) + c;
+                        q = mulmod(q, x > y ? x - y : y - x);
+                    }
+                    g = std::gcd(q, n);
+                }
+            }
+            if (g == n) {
+                do {
+                    ys = mulmod(ys, ys) + c;
+                    g = std::gcd(x > ys ? x - ys : ys - x, n);
+                } while (g == 1);
+            }
+            if (g != 1 && g != n) return g;
+        }
+        return 1;
+    }
+
+    struct SiqsShared {
+        const mpz_class& n;
+        mpz_class kn;
+        FactorBase fb;
+        Params params;
+        uint32_t M;
+        uint8_t threshold;
+        uint64_t large_prime_bound;
+        uint64_t double_large_bound;        // largest cofactor that is split into two large primes, 0 if off
+        size_t needed;                      // usable relations that guarantee dependencies
+        std::chrono::steady_clock::time_point deadline;
+
+        std::mutex mutex{};
+        std::set<mpz_class> used_A{};
+        std::vector<Relation> fulls{};
+        std::vector<Relation> partials{};
+        std::unordered_set<uint64_t> seen_Y{};  // low limb of every Y, a resumed job can sieve the same A again
+        std::ofstream store{};                  // open while relations are streamed to disk
+
+        // Partials are edges between their two large primes (1 for the unused slot). An edge inside one
+        // component closes a cycle, and the relations on a cycle multiply to a full relation.
+        std::unordered_map<uint64_t, uint32_t> vertex_of{{1, 0}};
+        std::vector<uint32_t> parent{0};
+
+        std::atomic<size_t> usable{0};      // fulls plus independent cycles of partials
+        std::atomic<size_t> full_count{0};
+        std::atomic<size_t> partial_count{0};
+        std::atomic<size_t> cycle_count{0};
+        std::atomic<bool> done{false};
+
+        [[nodiscard]] bool stopped() const {
+            return done.load() || std::chrono::steady_clock::now() > deadline;
+        }
+
+        uint32_t vertex(uint64_t prime) {
+            const auto [it, inserted] = vertex_of.try_emplace(prime, static_cast<uint32_t>(parent.size()));
+            if (inserted) parent.push_back(it->second);
+            return it->second;
+        }
+
+        uint32_t root(uint32_t v) {
+            while (parent[v] != v) v = parent[v] = parent[parent[v]];
+            return v;
+        }
+
+        void add(std::vector<Relation>& found, bool persist = true) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (Relation& relation : found) {
+                if (!seen_Y.insert(mpz_get_u64(relation.Y)).second) continue;
+                if (persist && store.is_open()) store << relation_line(relation);
+                if (relation.full()) {
+                    fulls.push_back(std::move(relation));
+                    ++full_count;
+                    ++usable;
+                    continue;
+                }
+                ++partial_count;
+                const uint32_t a = root(vertex(relation.large_primes[0]));
+                const uint32_t b = root(vertex(relation.large_primes[1]));
+                if (a == b) {
+                    ++cycle_count;
+                    ++usable;
+                } else {
+                    parent[a] = b;
+                }
+                partials.push_back(std::move(relation));
+            }
+            found.clear();
+            if (persist && store.is_open()) store.flush();
+            if (usable.load() >= needed) done = true;
+        }
+    };
+
+    // A = q_1 * ... * q_s close to sqrt(2kn)/M, built from factor base primes of similar size
+    bool choose_A(const SiqsShared& shared, std::mt19937_64& rng, std::vector<size_t>& q_index, mpz_class& A) {
+        const FactorBase& fb = shared.fb;
+        const size_t F = fb.prime.size();
+        mpz_class target;
+        mpz_sqrt(target.get_mpz_t(), mpz_class(2 * shared.kn).get_mpz_t());
+        target /= shared.M;
+        const double log_target = std::log(target.get_d());
+
+        size_t lo = fb.first_sieved;
+        while (lo < F && fb.sqrt_kn[lo] == 0) ++lo;
+        if (F - lo < 4) return false;
+        const double log_mid_prime = std::log(std::min<double>(2000, fb.prime[(lo + F) / 2]));
+        const size_t s = std::max<size_t>(1, static_cast<size_t>(std::lround(log_target / log_mid_prime)));
+        const auto q_target = static_cast<uint32_t>(std::exp(log_target / static_cast<double>(s)));
+        size_t mid = std::lower_bound(fb.prime.begin() + static_cast<long>(lo), fb.prime.end(), q_target) - fb.prime.begin();
+        const size_t width = std::max<size_t>(2 * s, 20);
+        const size_t range_lo = mid > lo + width ? mid - width : lo;
+        const size_t range_hi = std::min(F, range_lo + 2 * width);
+
+        q_index.clear();
+        A = 1;
+        for (size_t attempt = 0; q_index.size() + 1 < s && attempt < 1000; ++attempt) {
+            const size_t i = range_lo + rng() % (range_hi - range_lo);
+            if (fb.sqrt_kn[i] == 0 || std::ranges::find(q_index, i) != q_index.end()) continue;
+            q_index.push_back(i);
+            A *= fb.prime[i];
+        }
+        if (q_index.size() + 1 < s) return false;
+
+        // last prime brings A as close to the target as possible
+        const double wanted = target.get_d() / A.get_d();
+        size_t best = F;
+        double best_distance = 1e300;
+        for (size_t i = lo; i < F; ++i) {
+            if (fb.sqrt_kn[i] == 0 || std::ranges::find(q_index, i) != q_index.end()) continue;
+            const double distance = std::fabs(std::log(fb.prime[i] / wanted));
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = i;
+            }
+        }
+        if (best == F) return false;
+        q_index.push_back(best);
+        A *= fb.prime[best];
+        return true;
+    }
+
+    struct Polynomial {
+        mpz_class A, B, C;
+        std::vector<size_t> q_index;
+    };
+
+    // Q(x)/A = A*x^2 + 2*B*x + C at x = pos - M, factored over the factor base
+    void trial_divide(const SiqsShared& shared, const Polynomial& poly, uint32_t pos,
+                      const std::vector<uint32_t>& root1, const std::vector<uint32_t>& root2,
+                      std::vector<Relation>& found) {
+        const FactorBase& fb = shared.fb;
+        const long x = static_cast<long>(pos) - static_cast<long>(shared.M);
+        mpz_class v = (poly.A * x + 2 * poly.B) * x + poly.C;
+        Relation relation;
+        relation.Y = poly.A * x + poly.B;
+        if (v < 0) {
+            relation.factors.push_back(0);
+            v = -v;
+        }
+        if (v == 0) return;
+        for (size_t q : poly.q_index) relation.factors.push_back(static_cast<uint32_t>(q + 1));
+
+        for (size_t i = 0; i < fb.prime.size(); ++i) {
+            const uint32_t p = fb.prime[i];
+            if (root1[i] != UNUSED) {
+                const uint32_t r = pos % p;
+                if (r != root1[i] && r != root2[i]) continue;
+            } else if (!mpz_divisible_ui_p(v.get_mpz_t(), p)) {
+                continue;
+            }
+            do {
+                mpz_divexact_ui(v.get_mpz_t(), v.get_mpz_t(), p);
+                relation.factors.push_back(static_cast<uint32_t>(i + 1));
+            } while (mpz_divisible_ui_p(v.get_mpz_t(), p));
+        }
+
+        if (v == 1) {
+            found.push_back(std::move(relation));
+            return;
+        }
+        if (mpz_sizeinbase(v.get_mpz_t(), 2) > 64) return;
+        const uint64_t cofactor = mpz_get_u64(v);
+        if (cofactor < shared.large_prime_bound) {
+            relation.large_primes[0] = cofactor;
+            found.push_back(std::move(relation));
+            return;
+        }
+        // below the square of the largest factor base prime the cofactor is prime and too large
+        const uint64_t largest = fb.prime.back();
+        if (cofactor >= shared.double_large_bound || cofactor < largest * largest) return;
+        if (mpz_probab_prime_p(v.get_mpz_t(), 1) != 0) return;
+        const uint64_t p = split_cofactor(cofactor);
+        const uint64_t q = cofactor / p;
+        if (p == 1 || p >= shared.large_prime_bound || q >= shared.large_prime_bound) return;
+        relation.large_primes[0] = std::min(p, q);
+        relation.large_primes[1] = std::max(p, q);
+        found.push_back(std::move(relation));
+    }
+
+    void siqs_thread(SiqsShared& shared, unsigned thread_id) {
+        const FactorBase& fb = shared.fb;
+        const size_t F = fb.prime.size();
+        const uint32_t interval = 2 * shared.M;
+        std::mt19937_64 rng(std::random_device{}() + thread_id * 7919);
+
+        std::vector<uint32_t> root1(F), root2(F), next1(F), next2(F);
+        std::vector<std::vector<uint32_t>> bainv;
+        std::vector<uint8_t> sieve(BLOCK_SIZE);
+        std::vector<Relation> found;
+        Polynomial poly;
+
+        while (!shared.stopped()) {
+            if (!choose_A(shared, rng, poly.q_index, poly.A)) continue;
+            {
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                if (!shared.used_A.insert(poly.A).second) continue;
+            }
+            const size_t s = poly.q_index.size();
+
+            // B_l = (A/q_l) * gamma with B_l^2 = kn mod q_l and B_l = 0 mod every other q
+            std::vector<mpz_class> Bl(s);
+            poly.B = 0;
+            for (size_t l = 0; l < s; ++l) {
+                const uint32_t q = fb.prime[poly.q_index[l]];
+                const mpz_class A_over_q = poly.A / q;
+                uint64_t gamma = static_cast<uint64_t>(fb.sqrt_kn[poly.q_index[l]])
+                                 * inverse_mod(mpz_fdiv_ui(A_over_q.get_mpz_t(), q), q) % q;
+                if (gamma > q / 2) gamma = q - gamma;
+                Bl[l] = A_over_q * static_cast<unsigned long>(gamma);
+                poly.B += Bl[l];
+            }
+
+            // roots of the first polynomial and the Gray code steps 2*B_l/A mod p
+            bainv.assign(s, std::vector<uint32_t>(F));
+            for (size_t i = 0; i < F; ++i) {
+                const uint32_t p = fb.prime[i];
+                const uint32_t a_mod = mpz_fdiv_ui(poly.A.get_mpz_t(), p);
+                if (i < fb.first_sieved || a_mod == 0) {
+                    root1[i] = root2[i] = UNUSED;
+                    continue;
+                }
+                const uint64_t ainv = inverse_mod(a_mod, p);
+                const uint64_t b_mod = mpz_fdiv_ui(poly.B.get_mpz_t(), p);
+                const uint64_t t = fb.sqrt_kn[i];
+                const uint64_t r1 = (t + p - b_mod) % p * ainv % p;
+                const uint64_t r2 = (2 * static_cast<uint64_t>(p) - t - b_mod) % p * ainv % p;
+                root1[i] = static_cast<uint32_t>((r1 + shared.M) % p);
+                root2[i] = static_cast<uint32_t>((r2 + shared.M) % p);
+                for (size_t l = 0; l < s; ++l) {
+                    bainv[l][i] = static_cast<uint32_t>(2 * (mpz_fdiv_ui(Bl[l].get_mpz_t(), p) * ainv % p) % p);
+                }
+            }
+
+            const uint32_t polynomials = 1u << (s - 1);
+            for (uint32_t index = 0; index < polynomials && !shared.stopped(); ++index) {
+                if (index > 0) {
+                    // the Gray code flips bit v, B_v changes sign
+                    const unsigned v = std::countr_zero(index);
+                    const bool negative = ((index ^ (index >> 1)) >> v) & 1;
+                    const std::vector<uint32_t>& step = bainv[v];
+                    if (negative) poly.B -= 2 * Bl[v];
+                    else poly.B += 2 * Bl[v];
+                    for (size_t i = fb.first_sieved; i < F; ++i) {
+                        if (root1[i] == UNUSED) continue;
+                        const uint32_t p = fb.prime[i];
+                        if (negative) {
+                            root1[i] += step[i]; if (root1[i] >= p) root1[i] -= p;
+                            root2[i] += step[i]; if (root2[i] >= p) root2[i] -= p;
+                        } else {
+                            root1[i] = root1[i] >= step[i] ? root1[i] - step[i] : root1[i] + p - step[i];
+                            root2[i] = root2[i] >= step[i] ? root2[i] - step[i] : root2[i] + p - step[i];
+                        }
+                    }
+                }
+                poly.C = (poly.B * poly.B - shared.kn) / poly.A;
+
+                std::copy(root1.begin(), root1.end(), next1.begin());
+                std::copy(root2.begin(), root2.end(), next2.begin());
+                for (uint32_t begin = 0; begin < interval; begin += BLOCK_SIZE) {
+                    const uint32_t end = begin + BLOCK_SIZE;
+                    std::fill(sieve.begin(), sieve.end(), 0);
+                    uint8_t* const block = sieve.data();
+                    for (size_t i = fb.first_sieved; i < F; ++i) {
+                        if (root1[i] == UNUSED) continue;
+                        const uint32_t p = fb.prime[i];
+                        const uint8_t logp = fb.logp[i];
+                        uint32_t r = next1[i];
+                        for (; r < end; r += p) block[r - begin] += logp;
+                        next1[i] = r;
+                        if (root2[i] == root1[i]) continue;
+                        r = next2[i];
+                        for (; r < end; r += p) block[r - begin] += logp;
+                        next2[i] = r;
+                    }
+                    for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+                        if (block[j] >= shared.threshold) trial_divide(shared, poly, begin + j, root1, root2, found);
+                    }
+                }
+                if (!found.empty()) shared.add(found);
+            }
+        }
+    }
+
+    // x^2 = y^2 mod n from one dependency of combined relations
+    mpz_class square_root(const SiqsShared& shared, const std::vector<const Relation*>& relations) {
+        const mpz_class& n = shared.n;
+        mpz_class X = 1;
+        std::vector<uint32_t> exponents(shared.fb.prime.size() + 1, 0);
+        std::unordered_map<uint64_t, uint32_t> large;
+        for (const Relation* relation : relations) {
+            X = X * relation->Y % n;
+            for (uint32_t c : relation->factors) ++exponents[c];
+            for (uint64_t prime : relation->large_primes) {
+                if (prime != 1) ++large[prime];
+            }
+        }
+        mpz_class Y = 1, power;
+        for (size_t c = 1; c < exponents.size(); ++c) {
+            if (exponents[c] % 2) return 0;
+            if (exponents[c] == 0) continue;
+            const mpz_class p = shared.fb.prime[c - 1];
+            mpz_powm_ui(power.get_mpz_t(), p.get_mpz_t(), exponents[c] / 2, n.get_mpz_t());
+            Y = Y * power % n;
+        }
+        for (const auto& [prime, count] : large) {
+            if (count % 2) return 0;
+            const mpz_class p = mpz_from_u64(prime);
+            mpz_powm_ui(power.get_mpz_t(), p.get_mpz_t(), count / 2, n.get_mpz_t());
+            Y = Y * power % n;
+        }
+        mpz_class g, difference = X - Y;
+        mpz_gcd(g.get_mpz_t(), difference.get_mpz_t(), n.get_mpz_t());
+        return (g != 1 && g != n) ? g : mpz_class(0);
+    }
+
+    mpz_class find_factor(SiqsShared& shared, unsigned num_threads) {
+        // every full relation is one row, and every partial outside a spanning forest of the large prime
+        // graph closes one cycle through the forest
+        std::vector<std::vector<const Relation*>> combined;
+        for (const Relation& relation : shared.fulls) combined.push_back({&relation});
+
+        const size_t vertices = shared.parent.size();
+        std::vector<std::vector<std::pair<uint32_t, size_t>>> edges(vertices);   // neighbour, partial index
+        std::vector<std::array<uint32_t, 2>> ends(shared.partials.size());
+        for (size_t i = 0; i < shared.partials.size(); ++i) {
+            const Relation& relation = shared.partials[i];
+            ends[i] = {shared.vertex_of.at(relation.large_primes[0]), shared.vertex_of.at(relation.large_primes[1])};
+            edges[ends[i][0]].emplace_back(ends[i][1], i);
+            if (ends[i][0] != ends[i][1]) edges[ends[i][1]].emplace_back(ends[i][0], i);
+        }
+        std::vector<uint32_t> up(vertices, UINT32_MAX), depth(vertices, 0);
+        std::vector<size_t> up_edge(vertices, SIZE_MAX);
+        std::vector<uint8_t> tree_edge(shared.partials.size(), 0);
+        for (uint32_t start = 0; start < vertices; ++start) {
+            if (up[start] != UINT32_MAX) continue;
+            up[start] = start;
+            std::vector<uint32_t> queue = {start};
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const uint32_t u = queue[head];
+                for (const auto& [w, i] : edges[u]) {
+                    if (up[w] != UINT32_MAX) continue;
+                    up[w] = u;
+                    up_edge[w] = i;
+                    depth[w] = depth[u] + 1;
+                    tree_edge[i] = 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        for (size_t i = 0; i < shared.partials.size(); ++i) {
+            if (tree_edge[i]) continue;
+            std::vector<const Relation*> cycle = {&shared.partials[i]};
+            uint32_t a = ends[i][0], b = ends[i][1];
+            while (a != b) {
+                if (depth[a] < depth[b]) std::swap(a, b);
+                cycle.push_back(&shared.partials[up_edge[a]]);
+                a = up[a];
+            }
+            combined.push_back(std::move(cycle));
+        }
+
+        std::vector<std::vector<uint32_t>> rows;
+        rows.reserve(combined.size());
+        std::vector<uint8_t> parity(shared.fb.prime.size() + 1);
+        for (const auto& relations : combined) {
+            std::fill(parity.begin(), parity.end(), 0);
+            for (const Relation* relation : relations) {
+                for (uint32_t c : relation->factors) parity[c] ^= 1;
+            }
+            std::vector<uint32_t> row;
+            for (uint32_t c = 0; c < parity.size(); ++c) {
+                if (parity[c]) row.push_back(c);
+            }
+            rows.push_back(std::move(row));
+        }
+
+        std::vector<std::vector<size_t>> dependencies;
+        if (rows.size() >= LANCZOS_MIN_ROWS) dependencies = lanczos_dependencies(rows, parity.size(), 64, num_threads);
+        if (dependencies.empty()) dependencies = gauss_dependencies(rows, parity.size(), 64);
+        for (const auto& dependency : dependencies) {
+            std::vector<const Relation*> relations;
+            for (size_t row : dependency) {
+                relations.insert(relations.end(), combined[row].begin(), combined[row].end());
+            }
+            if (mpz_class g = square_root(shared, relations); g != 0) return g;
+        }
+        return 0;
+    }
+}
+
+mpz_class siqs_factor(const mpz_class& n, unsigned num_threads, std::chrono::steady_clock::time_point deadline) {
+    if (n < 4 || mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) return 0;
+    if (mpz_even_p(n.get_mpz_t())) return 2;
+    mpz_class root;
+    if (mpz_perfect_square_p(n.get_mpz_t())) {
+        mpz_sqrt(root.get_mpz_t(), n.get_mpz_t());
+        return root;
+    }
+    // below 20 digits the sieve has nothing to work with, rho is instant there
+    if (mpz_sizeinbase(n.get_mpz_t(), 10) < 20) return pollard_rho_brent(n, num_threads, deadline);
+    if (num_threads == 0) num_threads = 1;
+
+    const unsigned long k = choose_multiplier(n);
+    const Params params = choose_params(n);
+    SiqsShared shared{n, n * k, {}, params, params.blocks * BLOCK_SIZE, 0, 0, 0, 0, deadline};
+
+    // factor base: 2 and the primes with kn a quadratic residue
+    FactorBase& fb = shared.fb;
+    for (uint32_t limit = 1 << 16; fb.prime.size() < params.fb_size; limit *= 2) {
+        fb = {};
+        for (uint32_t p : small_primes(limit)) {
+            const uint32_t n_mod = mpz_fdiv_ui(n.get_mpz_t(), p);
+            if (n_mod == 0) return p;
+            const uint32_t kn_mod = mpz_fdiv_ui(shared.kn.get_mpz_t(), p);
+            if (p != 2 && kn_mod != 0 && powmod(kn_mod, (p - 1) / 2, p) != 1) continue;
+            fb.prime.push_back(p);
+            fb.sqrt_kn.push_back(p == 2 ? kn_mod % 2 : sqrt_mod(kn_mod, p));
+            fb.logp.push_back(static_cast<uint8_t>(std::lround(std::log2(p))));
+            if (fb.prime.size() == params.fb_size) break;
+        }
+    }
+    while (fb.first_sieved < fb.prime.size() && fb.prime[fb.first_sieved] < SMALL_PRIME) ++fb.first_sieved;
+
+    const uint64_t largest = fb.prime.back();
+    const size_t digits = mpz_sizeinbase(n.get_mpz_t(), 10);
+    shared.large_prime_bound = std::min<uint64_t>({largest * params.lp_mult, largest * largest, UINT32_MAX});
+    if (digits >= DOUBLE_LARGE_MIN_DIGITS) {
+        shared.double_large_bound = static_cast<uint64_t>(std::pow(static_cast<double>(shared.large_prime_bound), DOUBLE_LARGE_EXPONENT));
+    }
+    shared.needed = fb.prime.size() + 1 + EXTRA_RELATIONS;
+    // |Q(x)/A| is at most about M*sqrt(kn/2), everything that is left after the large primes and the
+    // unsieved small primes has to come from the sieve
+    const double max_bits = std::log2(shared.M) + (static_cast<double>(mpz_sizeinbase(shared.kn.get_mpz_t(), 2)) - 1) / 2;
+    const double slack = std::log2(static_cast<double>(std::max(shared.large_prime_bound, shared.double_large_bound))) + 4;
+    shared.threshold = static_cast<uint8_t>(std::clamp(max_bits - slack, 8.0, 250.0));
+
+    // relations of an earlier run on the same n and factor base are picked up again, new ones are appended
+    const std::string store_name = "siqs_" + n.get_str() + ".rel";
+    const std::string header = n.get_str() + ' ' + std::to_string(k) + ' ' + std::to_string(fb.prime.size());
+    if (digits >= STORE_MIN_DIGITS) {
+        std::ifstream previous(store_name);
+        std::string line;
+        if (std::getline(previous, line) && line == header) {
+            std::vector<Relation> loaded;
+            Relation relation;
+            while (std::getline(previous, line)) {
+                if (parse_relation(line, n, fb.prime, relation)) loaded.push_back(relation);
+            }
+            shared.add(loaded, false);
+            std::cout << "resumed " << shared.full_count.load() + shared.partial_count.load()
+                      << " relations from " << store_name << std::endl;
+            previous.close();
+            shared.store.open(store_name, std::ios::app);
+        } else {
+            previous.close();
+            shared.store.open(store_name, std::ios::trunc);
+            shared.store << header << '\n';
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads && !shared.stopped(); ++i) threads.emplace_back(siqs_thread, std::ref(shared), i);
+    while (!shared.stopped()) {
+        std::cout << "\rrelations: " << shared.usable.load() << " / " << shared.needed
+                  << " (" << shared.full_count.load() << " full, " << shared.partial_count.load() << " partial, "
+                  << shared.cycle_count.load() << " cycles)    " << std::flush;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    for (auto& t : threads) t.join();
+    std::cout << "\rrelations: " << shared.usable.load() << " / " << shared.needed << "                                        " << std::endl;
+
+    if (shared.usable.load() < shared.needed) return 0;
+    mpz_class factor = find_factor(shared, num_threads);
+    // a finished job has no use for its relations any more
+    if (factor != 0 && shared.store.is_open()) {
+        shared.store.close();
+        std::remove(store_name.c_str());
+    }
+    return factor;
+}
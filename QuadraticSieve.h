@@ -0,0 +1,17 @@
+#ifndef QUADRATICSIEVE_H
+#define QUADRATICSIEVE_H
+#include <chrono>
+#include <gmpxx.h>
+
+// Self-initializing quadratic sieve for balanced n of roughly 40 to 100 digits.
+// Every thread picks its own polynomial coefficients A, switches between the 2^(s-1) B values of each A
+// with a Gray code and sieves the interval [-M, M) in L1 sized blocks. Relations with up to two large
+// primes are collected, cycles in the graph of large primes combine partials into full relations, until the
+// GF(2) matrix has more rows than columns. The dependencies then give x^2 = y^2 mod n.
+// From 60 digits on the relations are streamed to siqs_<n>.rel in the working directory, a killed run on
+// the same n continues from there and the file is removed once a factor is found.
+// Returns a non-trivial factor of n, or 0 if none was found before the deadline.
+mpz_class siqs_factor(const mpz_class& n, unsigned num_threads,
+                      std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //QUADRATICSIEVE_H
@@ -0,0 +1,60 @@
+#include "RangeScheduler.h"
+
+RangeScheduler::RangeScheduler(const mpz_class& start, const mpz_class& end, unsigned num_workers, const mpz_class& grain)
+    : queues(num_workers == 0 ? 1 : num_workers), grain(grain < 1 ? mpz_class(1) : grain) {
+    if (end < start) return;
+    const mpz_class slice = (end - start + 1) / static_cast<unsigned long>(queues.size());
+    mpz_class current = start;
+    for (size_t i = 0; i < queues.size(); ++i) {
+        const mpz_class last = (i + 1 == queues.size()) ? end : current + slice - 1;
+        if (last >= current) queues[i].ranges.push_back({current, last});
+        current = last + 1;
+    }
+}
+
+bool RangeScheduler::pop_front(Queue& queue, Range& range) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) return false;
+    Range& front = queue.ranges.front();
+    if (front.end - front.start + 1 > grain) {
+        range = {front.start, front.start + grain - 1};
+        front.start += grain;
+    } else {
+        range = std::move(front);
+        queue.ranges.pop_front();
+    }
+    return true;
+}
+
+bool RangeScheduler::steal_back(Queue& queue, Range& range) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) return false;
+    Range& back = queue.ranges.back();
+    const mpz_class size = back.end - back.start + 1;
+    if (size > 2 * grain) {
+        // the owner works from the front, so the thief takes the upper half
+        const mpz_class middle = back.start + size / 2;
+        range = {middle, back.end};
+        back.end = middle - 1;
+    } else {
+        range = std::move(back);
+        queue.ranges.pop_back();
+    }
+    return true;
+}
+
+bool RangeScheduler::next(unsigned worker, Range& range) {
+    Queue& own = queues[worker % queues.size()];
+    if (pop_front(own, range)) return true;
+
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Range stolen;
+        if (!steal_back(queues[(worker + i) % queues.size()], stolen)) continue;
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.ranges.push_back(std::move(stolen));
+        }
+        if (pop_front(own, range)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,34 @@
+#ifndef RANGESCHEDULER_H
+#define RANGESCHEDULER_H
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <gmpxx.h>
+
+struct Range {
+    mpz_class start;
+    mpz_class end;  // inclusive
+};
+
+// Hands out sub-ranges of [start, end] of at most grain numbers.
+// Every worker starts with its own contiguous slice in its own deque and cuts pieces off the front.
+// A worker whose deque ran dry steals from the back of another one, splitting a large range in half,
+// so all workers stay busy until the whole range is handed out.
+class RangeScheduler {
+public:
+    RangeScheduler(const mpz_class& start, const mpz_class& end, unsigned num_workers, const mpz_class& grain);
+    // Next sub-range for worker, false once nothing is left anywhere
+    bool next(unsigned worker, Range& range);
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+    bool pop_front(Queue& queue, Range& range);
+    bool steal_back(Queue& queue, Range& range);
+
+    std::vector<Queue> queues;
+    mpz_class grain;
+};
+
+#endif //RANGESCHEDULER_H
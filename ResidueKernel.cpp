@@ -0,0 +1,148 @@
+#include "ResidueKernel.h"
+#include "MpzUtils.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RESIDUE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Handles primes in whole blocks and returns how many it did, the rest goes through GMP.
+    // residues[i] = n / 2^(32 * count) mod primes[i] for odd primes below 2^32
+    using Kernel = size_t (*)(const uint32_t* words, size_t count, const uint32_t* primes, uint32_t* residues, size_t size);
+
+#ifdef RESIDUE_KERNEL_X86
+    // Per word: t = r + w, m = t * (-p^-1) mod 2^32, r = (t + m*p) / 2^32, minus p if r >= p.
+    // r < p and w < 2^32 keep t + m*p below 2^64 and r below p + 2. -p^-1 comes from Newton steps on 32 bit
+    // lanes, p*p = 1 mod 8 gives 3 correct bits and every step doubles them.
+    // A step is a chain of two multiplies, so REGISTERS independent chains run side by side to hide the latency.
+    constexpr size_t REGISTERS = 8;
+
+    __attribute__((target("avx2")))
+    size_t kernel_avx2(const uint32_t* words, size_t count, const uint32_t* primes, uint32_t* residues, size_t size) {
+        constexpr size_t BLOCK = 4 * REGISTERS;
+        const __m256i two = _mm256_set1_epi32(2);
+        const __m256i pick = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        size_t i = 0;
+        for (; i + BLOCK <= size; i += BLOCK) {
+            __m256i p[REGISTERS], inverse[REGISTERS], r[REGISTERS];
+            for (size_t k = 0; k < REGISTERS; k += 2) {
+                const __m256i p32 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(primes + i + 4 * k));
+                __m256i x = p32;
+                for (int step = 0; step < 4; ++step) x = _mm256_mullo_epi32(x, _mm256_sub_epi32(two, _mm256_mullo_epi32(p32, x)));
+                x = _mm256_sub_epi32(_mm256_setzero_si256(), x);
+                p[k] = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(p32));
+                p[k + 1] = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(p32, 1));
+                inverse[k] = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x));
+                inverse[k + 1] = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1));
+            }
+            for (size_t k = 0; k < REGISTERS; ++k) r[k] = _mm256_setzero_si256();
+            for (size_t j = 0; j < count; ++j) {
+                const __m256i w = _mm256_set1_epi64x(words[j]);
+                for (size_t k = 0; k < REGISTERS; ++k) {
+                    const __m256i t = _mm256_add_epi64(r[k], w);
+                    const __m256i m = _mm256_mul_epu32(t, inverse[k]);
+                    r[k] = _mm256_srli_epi64(_mm256_add_epi64(t, _mm256_mul_epu32(m, p[k])), 32);
+                    // everything is below 2^33, so the signed compare is fine
+                    r[k] = _mm256_sub_epi64(r[k], _mm256_andnot_si256(_mm256_cmpgt_epi64(p[k], r[k]), p[k]));
+                }
+            }
+            // low 32 bits of every 64 bit lane, back in the order of the primes
+            for (size_t k = 0; k < REGISTERS; k += 2) {
+                const __m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(r[k], pick));
+                const __m128i high = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(r[k + 1], pick));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(residues + i + 4 * k), _mm256_set_m128i(high, low));
+            }
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    size_t kernel_avx512(const uint32_t* words, size_t count, const uint32_t* primes, uint32_t* residues, size_t size) {
+        constexpr size_t BLOCK = 8 * REGISTERS;
+        const __m512i two = _mm512_set1_epi32(2);
+        size_t i = 0;
+        for (; i + BLOCK <= size; i += BLOCK) {
+            __m512i p[REGISTERS], inverse[REGISTERS], r[REGISTERS];
+            for (size_t k = 0; k < REGISTERS; k += 2) {
+                const __m512i p32 = _mm512_loadu_si512(primes + i + 8 * k);
+                __m512i x = p32;
+                for (int step = 0; step < 4; ++step) x = _mm512_mullo_epi32(x, _mm512_sub_epi32(two, _mm512_mullo_epi32(p32, x)));
+                x = _mm512_sub_epi32(_mm512_setzero_si512(), x);
+                p[k] = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(p32));
+                p[k + 1] = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(p32, 1));
+                inverse[k] = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(x));
+                inverse[k + 1] = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(x, 1));
+            }
+            for (size_t k = 0; k < REGISTERS; ++k) r[k] = _mm512_setzero_si512();
+            for (size_t j = 0; j < count; ++j) {
+                const __m512i w = _mm512_set1_epi64(words[j]);
+                for (size_t k = 0; k < REGISTERS; ++k) {
+                    const __m512i t = _mm512_add_epi64(r[k], w);
+                    const __m512i m = _mm512_mul_epu32(t, inverse[k]);
+                    r[k] = _mm512_srli_epi64(_mm512_add_epi64(t, _mm512_mul_epu32(m, p[k])), 32);
+                    r[k] = _mm512_mask_sub_epi64(r[k], _mm512_cmpge_epu64_mask(r[k], p[k]), r[k], p[k]);
+                }
+            }
+            for (size_t k = 0; k < REGISTERS; ++k) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(residues + i + 8 * k), _mm512_cvtepi64_epi32(r[k]));
+            }
+        }
+        return i;
+    }
+#endif
+
+    struct Dispatch {
+        Kernel kernel;
+        const char* name;
+    };
+
+    // cpuid once, __builtin_cpu_supports also checks that the OS saves the wide registers.
+    // Without them GMP's divisibility test on 64 bit limbs beats anything on 32 bit words.
+    Dispatch select_kernel() {
+#ifdef RESIDUE_KERNEL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return {kernel_avx512, "AVX-512"};
+        if (__builtin_cpu_supports("avx2")) return {kernel_avx2, "AVX2"};
+#endif
+        return {nullptr, "scalar"};
+    }
+
+    const Dispatch& dispatch() {
+        static const Dispatch selected = select_kernel();
+        return selected;
+    }
+}
+
+ResidueKernel::ResidueKernel(const mpz_class& n) : n(n) {
+    words.resize((mpz_sizeinbase(n.get_mpz_t(), 2) + 31) / 32);
+    size_t count = 0;
+    mpz_export(words.data(), &count, -1, sizeof(uint32_t), 0, 0, n.get_mpz_t());
+    words.resize(count);
+}
+
+void ResidueKernel::find_divisors(const std::vector<uint64_t>& primes, std::vector<uint64_t>& divisors) const {
+    thread_local std::vector<uint32_t> odd;
+    thread_local std::vector<uint32_t> residues;
+    odd.clear();
+    for (uint64_t p : primes) {
+        if (p == 2) {
+            if (mpz_even_p(n.get_mpz_t())) divisors.push_back(2);
+        }
+        else if (p <= UINT32_MAX) odd.push_back(static_cast<uint32_t>(p));
+        else if (mpz_divisible_u64_p(n, p)) divisors.push_back(p);
+    }
+    residues.resize(odd.size());
+    size_t done = 0;
+    if (const Kernel kernel = dispatch().kernel) done = kernel(words.data(), words.size(), odd.data(), residues.data(), odd.size());
+    for (size_t i = 0; i < done; ++i) {
+        if (residues[i] == 0) divisors.push_back(odd[i]);
+    }
+    for (size_t i = done; i < odd.size(); ++i) {
+        if (mpz_divisible_u64_p(n, odd[i])) divisors.push_back(odd[i]);
+    }
+}
+
+const char* ResidueKernel::instruction_set() {
+    return dispatch().name;
+}
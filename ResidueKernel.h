@@ -0,0 +1,25 @@
+#ifndef RESIDUEKERNEL_H
+#define RESIDUEKERNEL_H
+#include <cstdint>
+#include <vector>
+#include <gmpxx.h>
+
+// Trial division of one big n by many word sized primes at once.
+// n is kept as 32 bit words and reduced word by word with Montgomery steps, r = (r + w) / 2^32 mod p,
+// which only needs 32x32 bit products and so maps onto the 64 bit lane multiplies of AVX2 (4 primes per
+// instruction) and AVX-512 (8 primes). The result n / 2^(32k) mod p is zero exactly when p divides n.
+// The widest kernel the CPU supports is picked once at runtime through cpuid. Without AVX2 every prime goes
+// through GMP's divisibility test, which on 64 bit limbs beats any scalar loop over 32 bit words.
+class ResidueKernel {
+public:
+    explicit ResidueKernel(const mpz_class& n);
+    // Appends every prime of primes that divides n to divisors, primes from 2^32 on go through GMP
+    void find_divisors(const std::vector<uint64_t>& primes, std::vector<uint64_t>& divisors) const;
+    // "AVX-512", "AVX2" or "scalar"
+    static const char* instruction_set();
+private:
+    mpz_class n;
+    std::vector<uint32_t> words;    // least significant first
+};
+
+#endif //RESIDUEKERNEL_H
@@ -0,0 +1,50 @@
+#include "SmallExponent.h"
+#include <vector>
+
+namespace {
+    constexpr size_t FILTER_PRIMES = 8;
+    constexpr unsigned long FILTER_PRIME_LIMIT = 1UL << 20;
+
+    // residues of c + k*n mod q, advanced by n mod q per k
+    struct ResidueFilter {
+        unsigned long q;
+        unsigned long step;
+        unsigned long residue;
+        std::vector<bool> is_power;
+    };
+
+    std::vector<ResidueFilter> make_filters(const mpz_class& c, unsigned long e, const mpz_class& n) {
+        std::vector<ResidueFilter> filters;
+        mpz_class q = 1 + e, power, x;
+        for (; q < FILTER_PRIME_LIMIT && filters.size() < FILTER_PRIMES; q += e) {
+            if (!mpz_probab_prime_p(q.get_mpz_t(), 25)) continue;
+            const unsigned long small_q = q.get_ui();
+            ResidueFilter filter{small_q, mpz_fdiv_ui(n.get_mpz_t(), small_q), mpz_fdiv_ui(c.get_mpz_t(), small_q),
+                                 std::vector<bool>(small_q, false)};
+            for (unsigned long i = 0; i < small_q; ++i) {
+                x = i;
+                mpz_powm_ui(power.get_mpz_t(), x.get_mpz_t(), e, q.get_mpz_t());
+                filter.is_power[power.get_ui()] = true;
+            }
+            filters.push_back(std::move(filter));
+        }
+        return filters;
+    }
+}
+
+bool small_message_root(const mpz_class& c, unsigned long e, const mpz_class& n, uint64_t multiples, mpz_class& m) {
+    if (e < 2 || c < 0 || n <= 0) return false;
+    std::vector<ResidueFilter> filters = make_filters(c, e, n);
+    mpz_class value = c;
+    for (uint64_t k = 0; k < multiples; ++k) {
+        bool candidate = true;
+        for (ResidueFilter& filter : filters) {
+            candidate = candidate && filter.is_power[filter.residue];
+            filter.residue += filter.step;
+            if (filter.residue >= filter.q) filter.residue -= filter.q;
+        }
+        if (candidate && mpz_root(m.get_mpz_t(), value.get_mpz_t(), e) != 0) return true;
+        value += n;
+    }
+    return false;
+}
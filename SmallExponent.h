@@ -0,0 +1,14 @@
+#ifndef SMALLEXPONENT_H
+#define SMALLEXPONENT_H
+#include <cstdint>
+#include <gmpxx.h>
+
+// Short messages under a small e (3, 17, ...) need no private key: if m^e = c + k*n for a small k, m is
+// just the integer e-th root of c + k*n. k = 0 is the textbook case m^e < n, larger k cover messages a
+// little longer than n^(1/e).
+// Every candidate is first checked against the e-th power residues mod a few primes q = 1 mod e, where
+// only about 1/e of all residues are e-th powers, so mpz_root only runs on the rare survivors.
+// Tries k = 0..multiples-1, returns true and sets m if one of them is a perfect e-th power.
+bool small_message_root(const mpz_class& c, unsigned long e, const mpz_class& n, uint64_t multiples, mpz_class& m);
+
+#endif //SMALLEXPONENT_H
@@ -0,0 +1,140 @@
+#include "Squfof.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    using u128 = unsigned __int128;
+
+    constexpr size_t MAX_BITS = 100;            // k*n and the forms still fit 128 and 64 bit words
+    constexpr uint64_t MULTIPLIERS[] = {1, 3, 5, 7, 11, 15, 21, 33, 35, 55, 77, 105, 165, 231, 385, 1155};
+    constexpr uint64_t CHECK_INTERVAL = 1 << 12;    // steps between looks at the deadline and the other threads
+
+    struct SqufofShared {
+        u128 n;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<size_t> next_multiplier{0};
+        std::atomic<bool> done{false};
+        std::mutex mutex{};
+        u128 factor = 0;
+    };
+
+    uint64_t isqrt(u128 x) {
+        auto r = static_cast<uint64_t>(std::sqrt(static_cast<double>(x)));
+        while (static_cast<u128>(r) * r > x) --r;
+        while (static_cast<u128>(r + 1) * (r + 1) <= x) ++r;
+        return r;
+    }
+
+    constexpr uint64_t SQUARES_MOD_64 = [] {
+        uint64_t mask = 0;
+        for (uint64_t i = 0; i < 64; ++i) mask |= 1ULL << (i * i % 64);
+        return mask;
+    }();
+
+    bool is_square(uint64_t q, uint64_t& root) {
+        if (!((SQUARES_MOD_64 >> (q & 63)) & 1)) return false;
+        root = isqrt(q);
+        return root * root == q;
+    }
+
+    u128 gcd(u128 a, u128 b) {
+        while (b != 0) {
+            const u128 t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Forward through the continued fraction of sqrt(kn) to a square Q at an even index, then backwards
+    // from its square root until P repeats, gcd(n, P) is the factor. A trivial result resumes the forward walk.
+    // Unsigned wrap-around is fine in the Q updates, the true results are always positive.
+    u128 squfof_multiplier(SqufofShared& shared, uint64_t k) {
+        const u128 n = shared.n;
+        const u128 kn = n * k;
+        const uint64_t P0 = isqrt(kn);
+        if (static_cast<u128>(P0) * P0 == kn) {
+            const u128 g = gcd(n, P0);
+            return g != 1 && g != n ? g : 0;
+        }
+        const auto bound = static_cast<uint64_t>(6 * std::sqrt(2 * static_cast<double>(P0)));
+
+        uint64_t P = P0, Q_prev = 1, Q = static_cast<uint64_t>(kn - static_cast<u128>(P0) * P0);
+        for (uint64_t i = 2; i < bound; ++i) {
+            if (i % CHECK_INTERVAL == 0 && (shared.done.load() || std::chrono::steady_clock::now() > shared.deadline)) return 0;
+            const uint64_t b = (P0 + P) / Q;
+            const uint64_t P_next = b * Q - P;
+            const uint64_t Q_next = Q_prev + b * (P - P_next);
+            Q_prev = Q;
+            Q = Q_next;
+            P = P_next;
+
+            uint64_t r;
+            if (i % 2 || !is_square(Q, r)) continue;
+            uint64_t Pr = (P0 - P) / r * r + P;
+            uint64_t Qr_prev = r;
+            auto Qr = static_cast<uint64_t>((kn - static_cast<u128>(Pr) * Pr) / r);
+            for (uint64_t j = 0; j < bound; ++j) {
+                const uint64_t br = (P0 + Pr) / Qr;
+                const uint64_t Pr_next = br * Qr - Pr;
+                if (Pr_next == Pr) break;
+                const uint64_t Qr_next = Qr_prev + br * (Pr - Pr_next);
+                Qr_prev = Qr;
+                Qr = Qr_next;
+                Pr = Pr_next;
+            }
+            const u128 g = gcd(n, Pr);
+            if (g != 1 && g != n) return g;
+        }
+        return 0;
+    }
+
+    void squfof_thread(SqufofShared& shared) {
+        for (size_t m = shared.next_multiplier++; m < std::size(MULTIPLIERS) && !shared.done.load();
+             m = shared.next_multiplier++) {
+            if (std::chrono::steady_clock::now() > shared.deadline) return;
+            const u128 g = squfof_multiplier(shared, MULTIPLIERS[m]);
+            if (g == 0) continue;
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.done.load()) {
+                shared.factor = g;
+                shared.done = true;
+            }
+            return;
+        }
+    }
+
+    mpz_class to_mpz(u128 x) {
+        mpz_class result;
+        const uint64_t words[2] = {static_cast<uint64_t>(x), static_cast<uint64_t>(x >> 64)};
+        mpz_import(result.get_mpz_t(), 2, -1, sizeof(uint64_t), 0, 0, words);
+        return result;
+    }
+}
+
+mpz_class squfof_factor(const mpz_class& n, unsigned num_threads, std::chrono::steady_clock::time_point deadline) {
+    if (n < 4 || mpz_sizeinbase(n.get_mpz_t(), 2) > MAX_BITS || mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) return 0;
+    // the multipliers must not share a factor with n
+    for (unsigned long p : {2, 3, 5, 7, 11}) {
+        if (mpz_divisible_ui_p(n.get_mpz_t(), p)) return p;
+    }
+
+    SqufofShared shared{0, deadline};
+    uint64_t words[2] = {0, 0};
+    mpz_export(words, nullptr, -1, sizeof(uint64_t), 0, 0, n.get_mpz_t());
+    shared.n = static_cast<u128>(words[1]) << 64 | words[0];
+
+    num_threads = std::clamp<unsigned>(num_threads, 1, std::size(MULTIPLIERS));
+    if (num_threads == 1) {
+        squfof_thread(shared);
+    } else {
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < num_threads; ++i) threads.emplace_back(squfof_thread, std::ref(shared));
+        for (auto& t : threads) t.join();
+    }
+    return to_mpz(shared.factor);
+}
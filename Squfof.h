@@ -0,0 +1,14 @@
+#ifndef SQUFOF_H
+#define SQUFOF_H
+#include <chrono>
+#include <gmpxx.h>
+
+// Shanks' square forms factorization for n of about 40 to 100 bits, O(n^1/4) steps.
+// The continued fraction of sqrt(k*n) only involves numbers around sqrt(k*n), so everything runs on
+// 64 bit words. Every thread takes the next of the square free multipliers k built from 3, 5, 7 and 11,
+// the first form that reaches a proper square wins.
+// Returns a non-trivial factor of n, or 0 if n is out of range, prime or the multipliers ran out.
+mpz_class squfof_factor(const mpz_class& n, unsigned num_threads,
+                        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //SQUFOF_H
@@ -0,0 +1,30 @@
+#include "TrialDivision.h"
+#include <algorithm>
+#include "MpzUtils.h"
+#include "ProductTree.h"
+
+BatchTrialDivider::BatchTrialDivider(const mpz_class& n) : n(n) {
+    // measured optimum: a block product of a few times the size of n
+    block_size = std::max<size_t>(1024, mpz_sizeinbase(n.get_mpz_t(), 2) / 4);
+}
+
+void BatchTrialDivider::find_divisors(const std::vector<uint64_t>& primes, std::vector<uint64_t>& divisors) const {
+    for (size_t first = 0; first < primes.size(); first += block_size) {
+        const size_t last = std::min(primes.size(), first + block_size);
+        std::vector<mpz_class> leaves;
+        leaves.reserve(last - first);
+        for (size_t i = first; i < last; ++i) leaves.push_back(mpz_from_u64(primes[i]));
+        ProductTree tree(std::move(leaves));
+
+        mpz_class r, g;
+        mpz_mod(r.get_mpz_t(), n.get_mpz_t(), tree.root().get_mpz_t());
+        mpz_gcd(g.get_mpz_t(), r.get_mpz_t(), tree.root().get_mpz_t());
+        if (g == 1) continue;
+
+        // g is the product of the dividing primes, so exactly those leaves leave no remainder
+        const std::vector<mpz_class> rest = tree.remainders(g);
+        for (size_t i = 0; i < rest.size(); ++i) {
+            if (rest[i] == 0) divisors.push_back(primes[first + i]);
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef TRIALDIVISION_H
+#define TRIALDIVISION_H
+#include <cstdint>
+#include <vector>
+#include <gmpxx.h>
+
+// Trial division of one huge n by whole blocks of primes: the block is multiplied up in a product tree,
+// n is reduced once modulo the block product and a gcd tells whether any prime of the block divides n.
+// Only blocks with a non-trivial gcd are walked down the remainder tree to find the dividing primes.
+class BatchTrialDivider {
+public:
+    // Below this size GMP's single limb divisibility test per prime is faster than building the trees
+    static constexpr size_t MIN_BITS = 32768;
+
+    explicit BatchTrialDivider(const mpz_class& n);
+    // Appends every prime of primes that divides n to divisors
+    void find_divisors(const std::vector<uint64_t>& primes, std::vector<uint64_t>& divisors) const;
+private:
+    mpz_class n;
+    size_t block_size;  // primes per product tree
+};
+
+#endif //TRIALDIVISION_H
@@ -0,0 +1,34 @@
+#include "Wiener.h"
+
+mpz_class wiener_factor(const mpz_class& e, const mpz_class& n) {
+    if (e <= 0 || n < 6) return 0;
+
+    // convergents k/d of e/n: k_i = a_i k_(i-1) + k_(i-2), the same for d
+    mpz_class numerator = e, denominator = n;
+    mpz_class k_previous = 0, k = 1;    // k_(-2), k_(-1)
+    mpz_class d_previous = 1, d = 0;
+    mpz_class a, remainder, next, phi, sum, discriminant, root;
+    while (denominator != 0) {
+        mpz_fdiv_qr(a.get_mpz_t(), remainder.get_mpz_t(), numerator.get_mpz_t(), denominator.get_mpz_t());
+        numerator = denominator;
+        denominator = remainder;
+        next = a * k + k_previous;
+        k_previous = k;
+        k = next;
+        next = a * d + d_previous;
+        d_previous = d;
+        d = next;
+
+        if (k == 0) continue;
+        phi = e * d - 1;
+        if (!mpz_divisible_p(phi.get_mpz_t(), k.get_mpz_t())) continue;
+        mpz_divexact(phi.get_mpz_t(), phi.get_mpz_t(), k.get_mpz_t());
+        sum = n - phi + 1;
+        discriminant = sum * sum - 4 * n;
+        if (discriminant < 0 || !mpz_perfect_square_p(discriminant.get_mpz_t())) continue;
+        mpz_sqrt(root.get_mpz_t(), discriminant.get_mpz_t());
+        const mpz_class p = (sum + root) / 2;
+        if (p > 1 && p < n && n % p == 0) return p;
+    }
+    return 0;
+}
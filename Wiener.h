@@ -0,0 +1,12 @@
+#ifndef WIENER_H
+#define WIENER_H
+#include <gmpxx.h>
+
+// Wiener's attack on RSA keys with a small private exponent, d < n^1/4 / 3.
+// Then k/d is one of the convergents of the continued fraction of e/n, where ed = 1 + k*phi(n). Every
+// convergent gives a candidate phi = (ed - 1) / k, and p, q are the roots of x^2 - (n - phi + 1)x + n.
+// Takes O(log n) convergents, so it costs microseconds and can run before any factoring.
+// Returns p, or 0 if d is too large for the attack.
+mpz_class wiener_factor(const mpz_class& e, const mpz_class& n);
+
+#endif //WIENER_H
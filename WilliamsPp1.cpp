@@ -0,0 +1,146 @@
+#include "WilliamsPp1.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+    constexpr unsigned long D = 2310;           // giant step, 2*3*5*7*11
+    constexpr size_t CHECKPOINT = 256;          // stage 2 primes between two gcds
+
+    struct Pp1Shared {
+        const mpz_class& n;
+        const mpz_class& k_B1;
+        const std::vector<unsigned long>& stage2_primes;
+        unsigned num_seeds;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<unsigned> next_seed{0};
+        std::atomic<bool> done{false};
+        std::mutex mutex{};
+        mpz_class factor{0};
+
+        [[nodiscard]] bool stopped() const {
+            return done.load() || std::chrono::steady_clock::now() > deadline;
+        }
+    };
+
+    // 2/7 and 6/5 are the classic seeds that make p+1 rather than p-1 likely, after that random ones
+    mpz_class seed(unsigned index, const mpz_class& n, std::mt19937_64& rng) {
+        mpz_class numerator, denominator = 1;
+        if (index == 0) { numerator = 2; denominator = 7; }
+        else if (index == 1) { numerator = 6; denominator = 5; }
+        else numerator = mpz_class(static_cast<unsigned long>(rng() >> 34)) + 3;
+        mpz_class A;
+        if (mpz_invert(A.get_mpz_t(), denominator.get_mpz_t(), n.get_mpz_t()) == 0) return numerator;
+        return (A * numerator) % n;
+    }
+
+    // Stage 2 on V = V_{k_B1}(A): V_{kD} - V_j vanishes mod p when p+1 divides k_B1 * (kD +- j)
+    mpz_class stage2(Pp1Shared& shared, const mpz_class& V) {
+        const mpz_class& n = shared.n;
+        const std::vector<unsigned long>& primes = shared.stage2_primes;
+        if (primes.empty()) return 1;
+
+        // baby steps V_j for odd j < D/2 via V_{j+2} = V_j*V_2 - V_{j-2}
+        std::vector<mpz_class> baby(D / 2 + 1);
+        const mpz_class V2 = lucas_v(2, V, n);
+        baby[1] = V;
+        mpz_class previous = V;     // V_{-1} = V_1
+        for (unsigned long j = 3; j <= D / 2; j += 2) {
+            baby[j] = (baby[j - 2] * V2 - previous) % n;
+            if (baby[j] < 0) baby[j] += n;
+            previous = baby[j - 2];
+        }
+
+        // giant steps V_{kD} via V_{(k+1)D} = V_{kD}*V_D - V_{(k-1)D}
+        const mpz_class VD = lucas_v(D, V, n);
+        unsigned long k = (primes[0] + D / 2) / D;
+        mpz_class Vk = lucas_v(mpz_class(k) * D, V, n);
+        // V_{-D} = V_D
+        mpz_class Vk_previous = k == 0 ? VD : lucas_v(mpz_class(k - 1) * D, V, n);
+
+        mpz_class acc = 1, diff, g;
+        for (size_t i = 0; i < primes.size(); ++i) {
+            const unsigned long q = primes[i];
+            for (; k < (q + D / 2) / D; ++k) {
+                mpz_class Vk_next = (Vk * VD - Vk_previous) % n;
+                if (Vk_next < 0) Vk_next += n;
+                Vk_previous = std::move(Vk);
+                Vk = std::move(Vk_next);
+            }
+            const unsigned long j = q > k * D ? q - k * D : k * D - q;
+            mpz_sub(diff.get_mpz_t(), Vk.get_mpz_t(), baby[j].get_mpz_t());
+            mpz_mul(acc.get_mpz_t(), acc.get_mpz_t(), diff.get_mpz_t());
+            mpz_mod(acc.get_mpz_t(), acc.get_mpz_t(), n.get_mpz_t());
+            if ((i + 1) % CHECKPOINT == 0 || i + 1 == primes.size()) {
+                mpz_gcd(g.get_mpz_t(), acc.get_mpz_t(), n.get_mpz_t());
+                if (g != 1 || shared.stopped()) return g;
+            }
+        }
+        return 1;
+    }
+
+    void pp1_thread(Pp1Shared& shared, unsigned thread_id) {
+        const mpz_class& n = shared.n;
+        std::mt19937_64 rng(std::random_device{}() + thread_id * 7919);
+        for (unsigned index = shared.next_seed++; index < shared.num_seeds; index = shared.next_seed++) {
+            if (shared.stopped()) return;
+            const mpz_class A = seed(index, n, rng);
+
+            // Stage 1: V_{k_B1}(A)
+            const mpz_class V = lucas_v(shared.k_B1, A, n);
+            mpz_class g, V_minus_2 = V - 2;
+            mpz_gcd(g.get_mpz_t(), V_minus_2.get_mpz_t(), n.get_mpz_t());
+            if (g == 1) g = stage2(shared, V);
+            if (g == 1 || g == n) continue;
+
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.done) {
+                shared.factor = g;
+                shared.done = true;
+            }
+            return;
+        }
+    }
+}
+
+mpz_class lucas_v(const mpz_class& k, const mpz_class& A, const mpz_class& n) {
+    mpz_class R0 = 2;   // V_0
+    mpz_class R1 = A;   // V_1
+
+    size_t num_bits = mpz_sizeinbase(k.get_mpz_t(), 2);
+    for (size_t i = num_bits; i-- > 0;) {
+        if (mpz_tstbit(k.get_mpz_t(), i) == 0) {
+            R1 = (R0 * R1 - A) % n;     // V_{2m+1} = V_m*V_{m+1} - V_1
+            R0 = (R0 * R0 - 2) % n;     // V_{2m} = V_m^2 - 2
+        } else {
+            R0 = (R0 * R1 - A) % n;
+            R1 = (R1 * R1 - 2) % n;
+        }
+    }
+    if (R0 < 0) R0 += n;
+    return R0;
+}
+
+mpz_class williams_pp1(const mpz_class& n, const mpz_class& k_B1, unsigned long B1, unsigned long B2,
+                       const std::vector<mpz_class>& primes, unsigned num_seeds, unsigned num_threads,
+                       std::chrono::steady_clock::time_point deadline) {
+    if (n < 4) return 0;
+    if (mpz_even_p(n.get_mpz_t())) return 2;
+    if (num_threads == 0) num_threads = 1;
+
+    std::vector<unsigned long> stage2_primes;
+    for (const auto& p : primes) {
+        if (p <= B1) continue;
+        if (p > B2) break;
+        stage2_primes.push_back(p.get_ui());
+    }
+
+    Pp1Shared shared{n, k_B1, stage2_primes, num_seeds, deadline};
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::min(num_threads, num_seeds); ++i) {
+        threads.emplace_back(pp1_thread, std::ref(shared), i);
+    }
+    for (auto& t : threads) t.join();
+    return shared.factor;
+}
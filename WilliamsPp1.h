@@ -0,0 +1,17 @@
+#ifndef WILLIAMSPP1_H
+#define WILLIAMSPP1_H
+#include <chrono>
+#include <vector>
+#include <gmpxx.h>
+
+// V_k(A) mod n of the Lucas sequence V_0 = 2, V_1 = A, V_{m+1} = A*V_m - V_{m-1}
+[[nodiscard]] mpz_class lucas_v(const mpz_class& k, const mpz_class& A, const mpz_class& n);
+
+// Williams p+1, finds p when p+1 (or p-1, depending on the seed) is B1-smooth apart from one prime in (B1, B2].
+// Every thread takes the next seed A until num_seeds seeds are tried, k_B1 and primes are the tables
+// the elliptic curve branch builds. Returns a non-trivial factor of n, or 0.
+mpz_class williams_pp1(const mpz_class& n, const mpz_class& k_B1, unsigned long B1, unsigned long B2,
+                       const std::vector<mpz_class>& primes, unsigned num_seeds, unsigned num_threads,
+                       std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+#endif //WILLIAMSPP1_H
@@ -8,8 +8,35 @@
 #include <cmath>
 #include <iomanip>
 #include <bits/random.h>
-
+#include <optional>
+#include <fstream>
+#include <sstream>
+#include <climits>
+#include <map>
+
+#include "Autotune.h"
+#include "BatchGcd.h"
+#include "BonehDurfee.h"
+#include "CommonModulus.h"
+#include "Coppersmith.h"
+#include "Fermat.h"
+#include "FranklinReiter.h"
+#include "HartLehman.h"
 #include "MontgomeryCurve.h"
+#include "MpzUtils.h"
+#include "PollardPm1.h"
+#include "PollardRho.h"
+#include "PollardStrassen.h"
+#include "PrimeSieve.h"
+#include "ProductTree.h"
+#include "QuadraticSieve.h"
+#include "RangeScheduler.h"
+#include "ResidueKernel.h"
+#include "SmallExponent.h"
+#include "Squfof.h"
+#include "TrialDivision.h"
+#include "Wiener.h"
+#include "WilliamsPp1.h"
 
 // Globals for thread communication
 std::atomic<bool> found(false);
@@ -17,40 +44,93 @@ std::mutex result_mutex;
 mpz_class final_p;
 mpz_class final_q;
 std::atomic<uint64_t> primes_checked(0);
+constexpr unsigned long TRIAL_DIVISION_GRAIN = 1UL << 24;  // numbers per sub-range handed out by the scheduler
+constexpr uint64_t FERMAT_PRECHECK_STEPS = 1ULL << 22;     // values of a Fermat tries before trial division starts
+constexpr uint64_t AUTO_TINY_PRIMES = 1ULL << 20;           // [A]uto trial divides up to here before anything else
+constexpr uint64_t BATCH_SMALL_FACTOR_BOUND = 1ULL << 24;   // default of the corpus wide trial division in [B]atch
+constexpr unsigned long SMALL_EXPONENT_LIMIT = 65537;       // e below this gets the e-th root check before factoring
+constexpr uint64_t SMALL_MESSAGE_MULTIPLES = 1ULL << 20;    // c + k*n tried by that check
+constexpr unsigned long RELATED_MESSAGE_EXPONENT_LIMIT = 1UL << 20; // Franklin-Reiter works with polynomials of degree e
+// [A]uto ECM levels: B1, the factor size in digits it is tuned for and the curves that usually takes
+struct EcmLevel {
+    unsigned long B1;
+    unsigned digits;
+    unsigned long curves;
+};
+constexpr EcmLevel AUTO_ECM_LEVELS[] = {
+    {2000, 15, 75}, {11000, 20, 270}, {50000, 25, 900}, {250000, 30, 2100}, {1000000, 35, 5400},
+    {3000000, 40, 15300}, {11000000, 45, 31800},
+};
+// [L] B1 by the digits of the smallest factor
+constexpr std::pair<unsigned, unsigned long> ECM_B1_LADDER[] = {
+    {40, 50000000}, {35, 10000000}, {30, 3000000}, {25, 1000000}, {20, 250000}, {15, 25000}, {10, 2000}, {0, 500},
+};
+constexpr double ECM_MAX_CURVE_SECONDS = 30;    // a guessed factor size never gets curves slower than this
+TuningProfile tuning;                           // host speeds from TUNING_PROFILE_FILE, defaults without one
     // Elliptic Curves
 std::mutex cout_mutex;
 std::atomic<bool> found_factor(false);
 std::atomic<unsigned long long> total_curves(0);
 std::mutex factor_mutex;
 
-void factor_thread(mpz_class n, const mpz_class& start, const mpz_class& end) {
-    mpz_class p;
+bool report_trial_factor(const mpz_class& n, const mpz_class& p) {
+    mpz_class q = n / p;
+    if (mpz_probab_prime_p(q.get_mpz_t(), 30) >= 1) {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        if(!found) {
+            final_p = p;
+            final_q = q;
+            found = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+void factor_thread(const mpz_class& n, const mpz_class& start, const mpz_class& end) {
+    mpz_class p = start;
+
+    // Everything up to PrimeSieve::LIMIT comes out of the wheel sieve, so each candidate only costs n mod p
+    if (const mpz_class sieve_limit = mpz_from_u64(PrimeSieve::LIMIT); p <= sieve_limit) {
+        const uint64_t sieve_end = end < sieve_limit ? mpz_get_u64(end) : PrimeSieve::LIMIT;
+        PrimeSieve sieve(mpz_get_u64(p), sieve_end);
+        // for huge n whole blocks of primes are checked with one reduction of n, below that the
+        // vectorized kernel tests a whole segment of primes against n
+        std::optional<BatchTrialDivider> batch;
+        std::optional<ResidueKernel> kernel;
+        if (mpz_sizeinbase(n.get_mpz_t(), 2) >= BatchTrialDivider::MIN_BITS) batch.emplace(n);
+        else kernel.emplace(n);
+        std::vector<uint64_t> primes;
+        std::vector<uint64_t> divisors;
+        while (!found.load() && sieve.next_segment(primes)) {
+            primes_checked += primes.size();
+            divisors.clear();
+            if (batch) batch->find_divisors(primes, divisors);
+            else kernel->find_divisors(primes, divisors);
+            for (uint64_t prime : divisors) {
+                if (report_trial_factor(n, mpz_from_u64(prime))) return;
+            }
+        }
+        p = mpz_from_u64(sieve_end) + 1;
+    }
 
-    mpz_class start_minus1 = start - 1;
+    mpz_class start_minus1 = p - 1;
     mpz_nextprime(p.get_mpz_t(), start_minus1.get_mpz_t());
 
     while (p <= end && !found.load()) {
         ++primes_checked;
         if (mpz_divisible_p(n.get_mpz_t(), p.get_mpz_t())) {
-            mpz_class q = n / p;
-            if (mpz_probab_prime_p(q.get_mpz_t(), 30) >= 1) {
-                std::lock_guard<std::mutex> lock(result_mutex);
-                if(!found) {
-                    final_p = p;
-                    final_q = q;
-                    found = true;
-                }
-                return;
-            }
+            if (report_trial_factor(n, p)) return;
         }
         mpz_nextprime(p.get_mpz_t(), p.get_mpz_t());
     }
 }
 
-void ecm_thread(const mpz_class &n, const mpz_class &k_B1, const mpz_class &k_B2,
-                const std::vector<mpz_class> &primes, gmp_randstate_t state, unsigned thread_id) {
+void ecm_thread(const mpz_class &n, const mpz_class &k_B1, unsigned long B1, unsigned long B2,
+                const std::vector<mpz_class> &primes, gmp_randstate_t state, unsigned thread_id,
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) {
 
-    while (!found_factor.load()) {
+    while (!found_factor.load() && std::chrono::steady_clock::now() < deadline) {
         ++total_curves;
 
         mpz_class A, x0;
@@ -88,8 +168,8 @@ void ecm_thread(const mpz_class &n, const mpz_class &k_B1, const mpz_class &k_B2
 
         mpz_class gcd2(1);
          for (const auto &p : primes) {
-             if (p <= k_B1) continue;
-             if (p > k_B2) break;
+             if (p <= B1) continue;
+             if (p > B2) break;
              Q = curve.scalar_multiply(p, Q);
              mpz_gcd(gcd2.get_mpz_t(), Q.Z.get_mpz_t(), n.get_mpz_t());
              if (gcd2 != 1 && gcd2 != n) break;
@@ -236,13 +316,356 @@ size_t estimate_total_primes(const mpz_class& max) {
     double max_d = mpz_get_d(max.get_mpz_t());
     return static_cast<size_t>(max_d / std::log(max_d));
 }
+// B1 for the elliptic curve, p-1 and p+1 stages, based on the expected length of the smallest factor of n
+unsigned long int choose_B1(const mpz_class& n, std::string& input) {
+    //TODO: rework
+    unsigned long int B1 = 500;
+    mpz_class digitsOfFactor;
+    bool guessed = false;
+    std::cout << "How many digits does the smallest factor have? Enter to skip and choose approximate value: ";
+    std::getline(std::cin, input);
+    trim(input);
+    if (!seq(input, "")) {
+        digitsOfFactor = input;
+        std::cout << "set the length of a factor of n to be approximately " << digitsOfFactor << " digits" << std::endl;
+    }
+    else {
+        // guess factor size to be ~sqrt n
+        mpz_class sqrt_n;
+        mpz_sqrt(sqrt_n.get_mpz_t(), n.get_mpz_t());
+        unsigned long int digits = mpz_sizeinbase(sqrt_n.get_mpz_t(), 10);
+        digitsOfFactor = digits;
+        guessed = true;
+        std::cout << "guessed the length of a factor n to be approximately " << digitsOfFactor << " digits" << std::endl;
+    }
+    // Basierend auf geschätzter Faktorbitlänge B1 auswählen
+    size_t level = 0;
+    // the last rung takes everything below it, negative sizes included
+    while (level + 1 < std::size(ECM_B1_LADDER) && digitsOfFactor < ECM_B1_LADDER[level].first) ++level;
+    B1 = ECM_B1_LADDER[level].second;
+    std::cout << "Based on length of factor of n chose B1 to be: " << B1 << std::endl;
+    if (tuning.loaded) {
+        // sqrt(n) is only an upper bound, on this machine a curve of that size might never finish
+        const size_t bits = mpz_sizeinbase(n.get_mpz_t(), 2);
+        while (guessed && level + 1 < std::size(ECM_B1_LADDER)
+               && ecm_curve_seconds(tuning, B1, ECM_B2_RATIO * B1, bits) > ECM_MAX_CURVE_SECONDS) {
+            B1 = ECM_B1_LADDER[++level].second;
+            std::cout << "curves would take too long on this machine, lowered B1 to " << B1 << std::endl;
+        }
+        std::cout << "expected time per curve: " << ecm_curve_seconds(tuning, B1, ECM_B2_RATIO * B1, bits) << " s" << std::endl;
+    }
+    return B1;
+}
+// Calculate all primes up to B2
+std::vector<mpz_class> primes_up_to(unsigned long int B2) {
+    std::vector<bool> is_prime(B2+1, true);
+    is_prime[0] = is_prime[1] = false;
+    for (unsigned long int i = 2; i * i <= B2; ++i) {
+        if (is_prime[i]) {
+            for (unsigned long int j = i * i; j <= B2; j += i) {
+                is_prime[j] = false;
+            }
+        }
+    }
+    std::vector<mpz_class> primes;
+    for (unsigned long int i = 2; i <= B2; ++i) {
+        if (is_prime[i]) primes.emplace_back(i);
+    }
+    std::cout << "found "<< primes.size() << " primes in range 2 to B2" << std::endl;
+    return primes;
+}
+// k = \prod_p^B (p)^(round-down to next int(log_p(B))) wobei p stets prim
+mpz_class stage_multiplier(const std::vector<mpz_class>& primes, unsigned long int B) {
+    mpz_class k(1);
+    for (const mpz_class& p : primes) {
+        if (p>B) break;
+        double exponent = std::floor(std::log(B)/std::log(p.get_d()));
+        mpz_class max_pow;
+        mpz_pow_ui(max_pow.get_mpz_t(), p.get_mpz_t(), static_cast<unsigned long long>(exponent));
+        mpz_lcm(k.get_mpz_t(), k.get_mpz_t(), max_pow.get_mpz_t());
+    }
+    return k;
+}
+unsigned int detect_threads() {
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) {
+        num_threads = 4;
+        std::cout << "couldn't detect amount of threads, using 4 instead" << std::endl;
+    }
+    else
+        std::cout << "detected " << num_threads << " threads" << std::endl;
+    return num_threads;
+}
+void print_elapsed(const std::chrono::high_resolution_clock::time_point& beginning) {
+    auto ending = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = ending - beginning;
+    long elapsedS = static_cast<long>(elapsed.count());
+    long elapsedHours = elapsedS / 3600;
+    long elapsedMinutes = (elapsedS % 3600) / 60;
+    long elapsedSeconds = elapsedS % 60;
+    if (elapsedHours > 0) std::cout << "Factorizing n took: " << elapsedHours << " Hours, " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
+    else if (elapsedMinutes > 0) std::cout << "Factorizing n took: " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
+    else std::cout << "Factorizing n took: " << elapsedSeconds << " Seconds" << std::endl;
+}
+// d = e^-1 mod (p-1)(q-1)
+mpz_class private_exponent(const mpz_class& e, const mpz_class& p, const mpz_class& q) {
+    mpz_class phi((p-1)*(q-1));
+    mpz_class d;
+    mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
+    return d;
+}
+// d = e^-1 mod phi(n) for any n, phi(p^k) = p^(k-1) (p-1)
+mpz_class private_exponent(const mpz_class& e, const std::map<mpz_class, unsigned long>& factors) {
+    mpz_class phi(1), power;
+    for (const auto& [p, k] : factors) {
+        mpz_pow_ui(power.get_mpz_t(), p.get_mpz_t(), k - 1);
+        phi *= power * (p - 1);
+    }
+    mpz_class d;
+    mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
+    return d;
+}
+// Prints the key pair and decodes a message with d, shared by all cracking modes.
+// A ciphertext entered before factoring isn't asked for again.
+void decode_with_private_exponent(const mpz_class& e, const mpz_class& n, const mpz_class& d,
+                                  const std::optional<mpz_class>& ciphertext = std::nullopt) {
+    std::string input;
+    std::cout << "Public key: (e = " << e << ", n = " << n << ")" << std::endl;
+    std::cout << "Private key: (d = " << d << ", n = " << n << ")" << std::endl;
+    bool crackLoop = true;
+    while (crackLoop) {
+        std::cout << "Do you want to get the decoded message as an int or a string?" << std::endl;
+        std::cout << "     [1] int" << std::endl;
+        std::cout << "     [2] string" << std::endl;
+        std::cout << "Enter your choice: ";
+        std::getline(std::cin, input);
+        trim(input);
+        switch (input[0]) {
+            case '1': {
+                mpz_class c = ciphertext.value_or(0);
+                if (!ciphertext) {
+                    std::cout << "Enter the encrypted message: ";
+                    std::getline(std::cin, input);
+                    trim(input);
+                    c = input;
+                }
+                mpz_class m;
+                mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
+                std::cout << "Decrypted message: " << m << std::endl;
+                crackLoop = false;
+                break;
+            }
+            case '2': {
+                mpz_class c = ciphertext.value_or(0);
+                if (!ciphertext) {
+                    std::cout << "Enter the encrypted message: ";
+                    std::getline(std::cin, input);
+                    trim(input);
+                    c = input;
+                }
+                mpz_class m;
+                mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
+                std::cout << "Decrypted message: " << mpz_to_ascii_string(m) << std::endl;
+                crackLoop = false;
+                break;
+            }
+            default: {
+                std::cout << "Invalid choice" << std::endl;
+            }
+        }
+    }
+}
+void decode_with_factors(const mpz_class& e, const mpz_class& n, const mpz_class& p, const mpz_class& q,
+                         const std::optional<mpz_class>& ciphertext = std::nullopt) {
+    decode_with_private_exponent(e, n, private_exponent(e, p, q), ciphertext);
+}
+// Output of a successful factorization, the same for every cracking mode
+void report_factors(const mpz_class& e, const mpz_class& n, const mpz_class& p, const mpz_class& q,
+                    const std::chrono::high_resolution_clock::time_point& beginning,
+                    const std::optional<mpz_class>& ciphertext = std::nullopt) {
+    std::cout << "\nFound p and q!" << std::endl;
+    std::cout << "p = " << p << std::endl;
+    std::cout << "q = " << q << std::endl;
+    print_elapsed(beginning);
+    decode_with_factors(e, n, p, q, ciphertext);
+}
+// The same for an n with more than two prime factors or a repeated one
+void report_factorization(const mpz_class& e, const mpz_class& n, const std::map<mpz_class, unsigned long>& factors,
+                          const std::chrono::high_resolution_clock::time_point& beginning) {
+    std::cout << "\nFound the prime factors of n!" << std::endl;
+    for (const auto& [p, k] : factors) {
+        std::cout << p;
+        if (k > 1) std::cout << "^" << k;
+        std::cout << std::endl;
+    }
+    print_elapsed(beginning);
+    decode_with_private_exponent(e, n, private_exponent(e, factors));
+}
+
+// With a small e a short message is the e-th root of c + k*n, no factoring needed. Asks for the ciphertext
+// up front and returns true if that decrypted it, otherwise ciphertext keeps it for after factoring.
+bool try_small_message(const mpz_class& e, const mpz_class& n, std::optional<mpz_class>& ciphertext) {
+    if (e >= SMALL_EXPONENT_LIMIT) return false;
+    std::string input;
+    std::cout << "e is small, enter the encrypted message to try an e-th root before factoring (empty to skip): ";
+    std::getline(std::cin, input);
+    trim(input);
+    if (seq(input, "")) return false;
+    ciphertext = mpz_class(input);
+    mpz_class m;
+    if (!small_message_root(*ciphertext, e.get_ui(), n, SMALL_MESSAGE_MULTIPLES, m)) {
+        std::cout << "the message is too long for an e-th root, factorizing n..." << std::endl;
+        return false;
+    }
+    std::cout << "m^e is less than " << SMALL_MESSAGE_MULTIPLES << " times n, the e-th root gives the message away" << std::endl;
+    std::cout << "Decrypted message: " << m << std::endl;
+    std::cout << "As a string: " << mpz_to_ascii_string(m) << std::endl;
+    return true;
+}
+
+// Runs ecm_thread on every thread with curves of the given B1 until a factor turns up or the deadline passes
+mpz_class run_ecm(const mpz_class& n, unsigned long B1, unsigned num_threads, std::chrono::steady_clock::time_point deadline) {
+    const unsigned long B2 = ECM_B2_RATIO * B1;
+    const std::vector<mpz_class> primes = primes_up_to(B2);
+    const mpz_class k_B1 = stage_multiplier(primes, B1);
+    found_factor = false;
+    total_curves = 0;
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            gmp_randstate_t local_state;
+            gmp_randinit_mt(local_state);
+            gmp_randseed_ui(local_state, std::random_device{}() + i * 7919);
+            ecm_thread(n, k_B1, B1, B2, primes, local_state, i, deadline);
+            gmp_randclear(local_state);
+        });
+    }
+    for (auto& t : threads) t.join();
+    return found_factor.load() ? final_p : mpz_class(0);
+}
+
+// [A]uto: checks that are instant or only work on special n come first, then the general methods with a
+// time budget that grows with the size of n, so a lucky structure is found before the long runs start.
+// Balanced n up to 100 digits end in the quadratic sieve, larger ones stay on ECM with growing B1.
+// Returns a non-trivial factor of n, or 0 if n is prime or no method split it.
+mpz_class auto_factor(const mpz_class& n, unsigned num_threads) {
+    if (n < 4 || mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) return 0;
+    const size_t digits = mpz_sizeinbase(n.get_mpz_t(), 10);
+    const size_t bits = mpz_sizeinbase(n.get_mpz_t(), 2);
+
+    // the sieve time roughly doubles every 8 digits, the special purpose methods get a share of it;
+    // a tuning profile knows how fast the sieve really is on this machine
+    const double sieve_seconds = tuning.loaded ? siqs_seconds(tuning, digits) / num_threads : 0;
+    const double base = tuning.loaded ? std::min(sieve_seconds / 8, 60.0)
+                                      : std::min(0.02 * std::exp2(static_cast<double>(digits) / 8), 60.0);
+    auto budget = [](double seconds) {
+        return std::chrono::steady_clock::now()
+             + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    };
+    auto stage = [](const std::string& name, double seconds) {
+        std::cout << "[auto] " << name;
+        if (seconds > 0) std::cout << " for up to " << std::fixed << std::setprecision(1) << seconds << " s" << std::defaultfloat;
+        std::cout << "..." << std::endl;
+    };
+
+    stage("perfect powers", 0);
+    mpz_class root;
+    if (mpz_perfect_power_p(n.get_mpz_t())) {
+        for (unsigned long k = mpz_sizeinbase(n.get_mpz_t(), 2); k >= 2; --k) {
+            if (mpz_root(root.get_mpz_t(), n.get_mpz_t(), k)) return root;
+        }
+    }
+
+    uint64_t tiny_limit = AUTO_TINY_PRIMES;
+    if (tuning.loaded) {
+        // as far as a small share of the base budget goes, sieving the primes costs about as much again
+        while (tiny_limit < (1ULL << 30)
+               && trial_division_seconds(tuning, estimate_total_primes(mpz_from_u64(2 * tiny_limit)), bits) < base / 16) tiny_limit *= 2;
+    }
+    stage("tiny primes up to " + std::to_string(tiny_limit), 0);
+    PrimeSieve sieve(2, tiny_limit);
+    std::vector<uint64_t> tiny;
+    while (sieve.next_segment(tiny)) {
+        for (uint64_t p : tiny) {
+            if (mpz_divisible_u64_p(n, p)) return mpz_from_u64(p);
+        }
+    }
+    if (mpz_fits_u64(n)) {
+        stage("Hart and Lehman", 0);
+        return mpz_from_u64(factor_u64(mpz_get_u64(n)));
+    }
+    if (bits <= 100) {
+        stage("SQUFOF", 0);
+        if (mpz_class p = squfof_factor(n, num_threads); p != 0) return p;
+    }
+
+    stage("Fermat", base);
+    if (mpz_class p = fermat_factor(n, UINT64_MAX, num_threads, budget(base)); p != 0) return p;
+    stage("Pollard rho", 2 * base);
+    if (mpz_class p = pollard_rho_brent(n, num_threads, budget(2 * base)); p != 0) return p;
+
+    const unsigned long pm1_B1 = 250000;
+    stage("Pollard p-1 with B1 = " + std::to_string(pm1_B1), 4 * base);
+    {
+        const std::vector<mpz_class> primes = primes_up_to(PM1_B2_RATIO * pm1_B1);
+        const mpz_class k_B1 = stage_multiplier(primes, pm1_B1);
+        if (mpz_class p = pollard_pm1(n, k_B1, pm1_B1, PM1_B2_RATIO * pm1_B1, primes, num_threads, budget(4 * base)); p != 0) return p;
+    }
+
+    // ECM until the factors it is tuned for reach a third of n, or with a profile until a level is expected to
+    // take longer than the sieve; balanced n are the sieve's job from there
+    double seconds = 4 * base;
+    for (const auto& [B1, factor_digits, curves] : AUTO_ECM_LEVELS) {
+        if (tuning.loaded) {
+            seconds = static_cast<double>(curves) * ecm_curve_seconds(tuning, B1, ECM_B2_RATIO * B1, bits) / num_threads;
+            if (digits <= 100 && seconds > sieve_seconds) break;
+        }
+        else if (digits <= 100 && 3 * factor_digits > digits) break;
+        stage("ECM with B1 = " + std::to_string(B1), seconds);
+        if (mpz_class p = run_ecm(n, B1, num_threads, budget(seconds)); p != 0) return p;
+        seconds *= 2;
+    }
+    if (digits <= 100) {
+        stage("quadratic sieve", 0);
+        return siqs_factor(n, num_threads);
+    }
+    const unsigned long B1 = AUTO_ECM_LEVELS[std::size(AUTO_ECM_LEVELS) - 1].B1;
+    stage("ECM with B1 = " + std::to_string(B1) + " until a factor is found", 0);
+    return run_ecm(n, B1, num_threads, std::chrono::steady_clock::time_point::max());
+}
+
+// Splits n into primes with auto_factor, every composite part gets the budgets of its own size.
+// Returns false with the part no method could split in unsplit.
+bool auto_factorize(const mpz_class& n, unsigned num_threads, std::map<mpz_class, unsigned long>& factors, mpz_class& unsplit) {
+    std::vector<mpz_class> parts{n};
+    while (!parts.empty()) {
+        const mpz_class part = parts.back();
+        parts.pop_back();
+        if (mpz_probab_prime_p(part.get_mpz_t(), 30) > 0) {
+            ++factors[part];
+            continue;
+        }
+        if (part != n) std::cout << "[auto] cofactor " << part << " is composite, splitting it too" << std::endl;
+        const mpz_class p = auto_factor(part, num_threads);
+        if (p <= 1 || p >= part) {
+            unsplit = part;
+            return false;
+        }
+        parts.push_back(p);
+        parts.push_back(part / p);
+    }
+    return true;
+}
 
 int main() {
     std::string input;
     std::cout << "/!\\ this might take a while..." << std::endl;
+    if (load_tuning_profile(tuning, TUNING_PROFILE_FILE)) {
+        std::cout << "loaded tuning profile from " << TUNING_PROFILE_FILE << std::endl;
+    }
     bool mainloop = true;
     while (mainloop) {
-        std::cout << "[E]ncode, [C]rack, [L]Elliptic Curve Cracking or [O]ther?: ";
+        std::cout << "[E]ncode, [C]rack, [L]Elliptic Curve Cracking, [R]ho Cracking, [P]-1 Cracking, [W]illiams p+1 Cracking, [F]ermat Cracking, [S]IQS Cracking, S[Q]UFOF Cracking, [D]eterministic Pollard-Strassen Cracking, [A]uto Cracking, [B]atch GCD over a file of moduli, small private [K]ey Boneh-Durfee Cracking, [H]astad broadcast over a file of ciphertexts, common [M]odulus attack over a file of ciphertexts, partial key e[X]posure Coppersmith Cracking, Franklin-Reiter related messa[G]es or [O]ther?: ";
         std::getline(std::cin, input);
         trim(input);
         if (seq(input, "e") || seq(input, "encode"))  {
@@ -345,74 +768,22 @@ int main() {
             trim(input);
             std::getline(std::cin, input);
             n = input;
-
-            // get B1 based on size of n
-            //TODO: rework
-            unsigned long int B1;
-            mpz_class digitsOfFactor;
-            std::cout << "How many digits does the smallest factor have? Enter to skip and choose approximate value: ";
-            std::getline(std::cin, input);
-            trim(input);
-            if (!seq(input, "")) {
-                digitsOfFactor = input;
-                std::cout << "set the length of a factor of n to be approximately " << digitsOfFactor << " digits" << std::endl;
-            }
-            else {
-                // guess factor size to be ~sqrt n
-                mpz_class sqrt_n;
-                mpz_sqrt(sqrt_n.get_mpz_t(), n.get_mpz_t());
-                unsigned long int digits = mpz_sizeinbase(sqrt_n.get_mpz_t(), 10);
-                digitsOfFactor = digits;
-                std::cout << "guessed the length of a factor n to be approximately " << digitsOfFactor << " digits" << std::endl;
-            }
-            // Basierend auf geschätzter Faktorbitlänge B1 auswählen
-            if (digitsOfFactor >= 40) B1 = 50000000;
-            else if (digitsOfFactor >= 35) B1 = 10000000;
-            else if (digitsOfFactor >= 30) B1 = 3000000;
-            else if (digitsOfFactor >= 25) B1 = 1000000;
-            else if (digitsOfFactor >= 20) B1 = 250000;
-            else if (digitsOfFactor >= 15) B1 = 25000;
-            else if (digitsOfFactor >= 10) B1 = 2000;
-            else B1 = 500;
-            std::cout << "Based on length of factor of n chose B1 to be: " << B1 << std::endl;
-
-            unsigned long int B2(50 * B1);
-
-            // Calculate all primes up to B2
-            std::vector<bool> is_prime(B2+1, true);
-            is_prime[0] = is_prime[1] = false;
-            for (unsigned long int i = 2; i * i <= B2; ++i) {
-                if (is_prime[i]) {
-                    for (unsigned long int j = i * i; j <= B2; j += i) {
-                        is_prime[j] = false;
-                    }
-                }
-            }
-            std::vector<mpz_class> primes;
-            for (unsigned long int i = 2; i <= B2; ++i) {
-                if (is_prime[i]) primes.emplace_back(i);
+            std::optional<mpz_class> ciphertext;
+            if (try_small_message(e, n, ciphertext)) continue;
+
+            // a small d gives the key away before the first curve
+            if (mpz_class p = wiener_factor(e, n); p != 0) {
+                std::cout << "d is small, Wiener's attack recovered it" << std::endl;
+                report_factors(e, n, p, n / p, std::chrono::high_resolution_clock::now(), ciphertext);
+                continue;
             }
-            std::cout << "found "<< primes.size() << " primes in range 2 to B2" << std::endl;
 
+            unsigned long int B1 = choose_B1(n, input);
+            unsigned long int B2(ECM_B2_RATIO * B1);
+            std::vector<mpz_class> primes = primes_up_to(B2);
 
-
-            // calculate k_Bx (the scalar for the point multiplication)
-            mpz_class k_B1(1);
-            mpz_class k_B2(1);
-            // k = \prod_p^B (p)^(round-down to next int(log_p(B))) wobei p stets prim
-            for (mpz_class p : primes) {
-                if (p>B1) break;
-                double exponent = std::floor(std::log(B1)/std::log(p.get_d()));
-                mpz_class max_pow;
-                mpz_pow_ui(max_pow.get_mpz_t(), p.get_mpz_t(), static_cast<unsigned long long>(exponent));
-                mpz_lcm(k_B1.get_mpz_t(), k_B1.get_mpz_t(), max_pow.get_mpz_t());
-            }
-            for (mpz_class p : primes) {
-                double exponent = std::floor(std::log(B2)/std::log(p.get_d()));
-                mpz_class max_pow;
-                mpz_pow_ui(max_pow.get_mpz_t(), p.get_mpz_t(), static_cast<unsigned long long>(exponent));
-                mpz_lcm(k_B2.get_mpz_t(), k_B2.get_mpz_t(), max_pow.get_mpz_t());
-            }
+            // calculate k_B1 (the scalar for the point multiplication), stage 2 goes through the primes up to B2
+            mpz_class k_B1 = stage_multiplier(primes, B1);
             std::cout << "k_B1: " << k_B1 << std::endl;
             auto curveBeginning = std::chrono::high_resolution_clock::now();
 
@@ -432,7 +803,7 @@ int main() {
                     unsigned long seed = std::random_device{}() + i * 7919;
                     gmp_randseed_ui(local_state, seed);
 
-                    ecm_thread(n, k_B1, k_B2, primes, local_state, i);
+                    ecm_thread(n, k_B1, B1, B2, primes, local_state, i);
 
                     gmp_randclear(local_state);
                 });
@@ -442,57 +813,8 @@ int main() {
                 if (t.joinable()) t.join();
             }
 
-            auto curveEnding = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> CurveElapsed = curveEnding - curveBeginning;
-            long elapsedS = static_cast<long>(CurveElapsed.count());
-            long elapsedHours = elapsedS / 3600;
-            long elapsedMinutes = (elapsedS % 3600) / 60;
-            long elapsedSeconds = elapsedS % 60;
-            if (elapsedHours > 0) std::cout << "Factorizing n took: " << elapsedHours << " Hours, " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
-            else if (elapsedMinutes > 0) std::cout << "Factorizing n took: " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
-            else std::cout << "Factorizing n took: " << elapsedSeconds << " Seconds" << std::endl;
-
-            mpz_class phi((final_p-1)*(final_q-1));
-            mpz_class d;
-            mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
-            std::cout << "Public key: (e = " << e << ", n = " << n << ")" << std::endl;
-            std::cout << "Private key: (d = " << d << ", n = " << n << ")" << std::endl;
-            bool crackLoop = true;
-            while (crackLoop) {
-                std::cout << "Do you want to get the decoded message as an int or a string?" << std::endl;
-                std::cout << "     [1] int" << std::endl;
-                std::cout << "     [2] string" << std::endl;
-                std::cout << "Enter your choice: ";
-                std::getline(std::cin, input);
-                trim(input);
-                switch (input[0]) {
-                    case '1': {
-                        std::cout << "Enter the encrypted message: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class c(input);
-                        mpz_class m;
-                        mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
-                        std::cout << "Decrypted message: " << m << std::endl;
-                        crackLoop = false;
-                        break;
-                    }
-                    case '2': {
-                        std::cout << "Enter the encrypted message: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class c(input);
-                        mpz_class m;
-                        mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
-                        std::cout << "Decrypted message: " << mpz_to_ascii_string(m) << std::endl;
-                        crackLoop = false;
-                        break;
-                    }
-                    default: {
-                        std::cout << "Invalid choice" << std::endl;
-                    }
-                }
-            }
+            print_elapsed(curveBeginning);
+            decode_with_factors(e, n, final_p, final_q, ciphertext);
             continue;
         }
 
@@ -512,35 +834,58 @@ int main() {
             trim(input);
             std::getline(std::cin, input);
             n = input;
+            std::optional<mpz_class> ciphertext;
+            if (try_small_message(e, n, ciphertext)) continue;
             auto beginning = std::chrono::high_resolution_clock::now();
             std::cout << "Trying to factorize n, this might take a while..." << std::endl;
             mpz_class max;
             mpz_sqrt(max.get_mpz_t(), n.get_mpz_t());
 
-            unsigned int NUM_THREADS = std::thread::hardware_concurrency();
-            if (NUM_THREADS == 0) {
-                NUM_THREADS = 4;
-                std::cout << "couldn't detect amount of threads, using 4 instead" << std::endl;
+            // a small d gives the key away without factoring
+            if (mpz_class p = wiener_factor(e, n); p != 0) {
+                std::cout << "d is small, Wiener's attack recovered it" << std::endl;
+                report_factors(e, n, p, n / p, beginning, ciphertext);
+                continue;
+            }
+
+            // anything below 2^64 is done on machine words, no threads needed
+            if (mpz_fits_u64(n)) {
+                if (uint64_t p = factor_u64(mpz_get_u64(n)); p != 0) {
+                    report_factors(e, n, mpz_from_u64(p), n / mpz_from_u64(p), beginning, ciphertext);
+                    continue;
+                }
+            }
+
+            unsigned int NUM_THREADS = detect_threads();
+
+            // up to 100 bits the square forms finish long before trial division would
+            if (mpz_class p = squfof_factor(n, NUM_THREADS); p != 0) {
+                report_factors(e, n, p, n / p, beginning, ciphertext);
+                continue;
             }
-            else
-                std::cout << "detected " << NUM_THREADS << " threads" << std::endl;
-            std::vector<std::thread> threads;
-            mpz_class current("2");
-            mpz_class range_step;
 
-            mpz_class max_minus_2 = max - 2;
-            mpz_class chunk_size = max_minus_2 / NUM_THREADS;
+            // close p and q (like the ones from [O]->[9]) fall to Fermat right away
+            if (mpz_class p = fermat_factor(n, FERMAT_PRECHECK_STEPS, NUM_THREADS); p != 0) {
+                report_factors(e, n, p, n / p, beginning, ciphertext);
+                continue;
+            }
+
+            std::vector<std::thread> threads;
+            RangeScheduler scheduler(2, max, NUM_THREADS, TRIAL_DIVISION_GRAIN);
 
+            std::cout << "testing primes with the " << ResidueKernel::instruction_set() << " kernel" << std::endl;
             std::thread progress_thread(progress_display, estimate_total_primes(max));
             std::cout << std::endl;
             found = false;
 
             // Launch Threads
-            for (int i = 0; i < NUM_THREADS; i++) {
-                mpz_class start = 2 + i * chunk_size;
-                mpz_class end = (i==NUM_THREADS-1) ? max : start + chunk_size;
-
-                threads.emplace_back(factor_thread, n, start, end);
+            for (unsigned int i = 0; i < NUM_THREADS; i++) {
+                threads.emplace_back([&, i]() {
+                    Range range;
+                    while (!found.load() && scheduler.next(i, range)) {
+                        factor_thread(n, range.start, range.end);
+                    }
+                });
             }
 
             for (auto& t: threads) t.join();
@@ -551,62 +896,601 @@ int main() {
             }
 
             std::this_thread::sleep_for(std::chrono::milliseconds(250));
-            std::cout << "\nFound p and q!" << std::endl;
-            std::cout << "p = " << final_p << std::endl;
-            std::cout << "q = " << final_q << std::endl;
-
             progress_thread.detach();
-            auto ending = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> elapsed = ending - beginning;
-            long elapsedS = static_cast<long>(elapsed.count());
-            long elapsedHours = elapsedS / 3600;
-            long elapsedMinutes = (elapsedS % 3600) / 60;
-            long elapsedSeconds = elapsedS % 60;
-            if (elapsedHours > 0) std::cout << "Factorizing n took: " << elapsedHours << " Hours, " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
-            else if (elapsedMinutes > 0) std::cout << "Factorizing n took: " << elapsedMinutes << " Minutes and " << elapsedSeconds << " Seconds" << std::endl;
-            else std::cout << "Factorizing n took: " << elapsedSeconds << " Seconds" << std::endl;
-
-            mpz_class phi((final_p-1)*(final_q-1));
-            mpz_class d;
-            mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
-            std::cout << "Public key: (e = " << e << ", n = " << n << ")" << std::endl;
-            std::cout << "Private key: (d = " << d << ", n = " << n << std::endl;
-            bool crackLoop = true;
-            while (crackLoop) {
-                std::cout << "Do you want to get the decoded message as an int or a string?" << std::endl;
-                std::cout << "     [1] int" << std::endl;
-                std::cout << "     [2] string" << std::endl;
-                std::cout << "Enter your choice: ";
-                std::getline(std::cin, input);
+            report_factors(e, n, final_p, final_q, beginning, ciphertext);
+            continue;
+        }
+
+        if (seq(input, "r") || seq(input, "rho")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with Pollard rho, best for factors up to ~25 digits..." << std::endl;
+
+            // independent walks with different polynomials on every thread
+            mpz_class p = pollard_rho_brent(n, detect_threads());
+            if (p == 0) {
+                std::cout << "failed to factorize n" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "p") || seq(input, "p-1")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+
+            // same B1 and tables as the elliptic curve branch, with the longer stage 2 of p-1 and p+1
+            unsigned long int B1 = choose_B1(n, input);
+            unsigned long int B2(PM1_B2_RATIO * B1);
+            std::vector<mpz_class> primes = primes_up_to(B2);
+            mpz_class k_B1 = stage_multiplier(primes, B1);
+
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with Pollard p-1, finds p if p-1 has no prime factor above B2..." << std::endl;
+            mpz_class p = pollard_pm1(n, k_B1, B1, B2, primes, detect_threads());
+            if (p == 0) {
+                std::cout << "failed to factorize n, p-1 and q-1 are not smooth enough for B1 = " << B1 << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "w") || seq(input, "p+1")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+
+            // same B1 and tables as the elliptic curve branch, with the longer stage 2 of p-1 and p+1
+            unsigned long int B1 = choose_B1(n, input);
+            unsigned long int B2(PM1_B2_RATIO * B1);
+            std::vector<mpz_class> primes = primes_up_to(B2);
+            mpz_class k_B1 = stage_multiplier(primes, B1);
+
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with Williams p+1, finds p if p+1 has no prime factor above B2..." << std::endl;
+            // every seed has a 50% chance to work on p+1, the rest land on p-1
+            unsigned int num_threads = detect_threads();
+            mpz_class p = williams_pp1(n, k_B1, B1, B2, primes, std::max(num_threads, 8u), num_threads);
+            if (p == 0) {
+                std::cout << "failed to factorize n, p+1 and q+1 are not smooth enough for B1 = " << B1 << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "f") || seq(input, "fermat")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            std::optional<mpz_class> ciphertext;
+            if (try_small_message(e, n, ciphertext)) continue;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            if (mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) {
+                std::cout << "n is prime, there is nothing to factorize" << std::endl;
+                continue;
+            }
+            std::cout << "Trying to factorize n with Fermat's method, fast if p and q are close together..." << std::endl;
+
+            mpz_class p = fermat_factor(n, UINT64_MAX, detect_threads());
+            if (p == 0) {
+                std::cout << "failed to factorize n" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning, ciphertext);
+            continue;
+        }
+
+        if (seq(input, "q") || seq(input, "squfof")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with SQUFOF, made for n of 40-100 bits..." << std::endl;
+
+            mpz_class p = squfof_factor(n, detect_threads());
+            if (p == 0) {
+                std::cout << "failed to factorize n" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "a") || seq(input, "auto")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with every method, cheapest first..." << std::endl;
+
+            if (mpz_probab_prime_p(n.get_mpz_t(), 30) > 0) {
+                std::cout << "failed to factorize n, it is prime" << std::endl;
+                continue;
+            }
+            std::map<mpz_class, unsigned long> factors;
+            mpz_class unsplit;
+            if (!auto_factorize(n, detect_threads(), factors, unsplit)) {
+                if (unsplit == n) std::cout << "failed to factorize n" << std::endl;
+                else std::cout << "failed to factorize n, no method split the cofactor " << unsplit << std::endl;
+                continue;
+            }
+            if (factors.size() == 2 && factors.begin()->second == 1 && factors.rbegin()->second == 1) {
+                report_factors(e, n, factors.begin()->first, factors.rbegin()->first, beginning);
+            }
+            else report_factorization(e, n, factors, beginning);
+            continue;
+        }
+
+        if (seq(input, "b") || seq(input, "batch")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // one modulus per line, empty lines and lines starting with # are skipped
+            std::cout << "Enter the path of a file with one n per line: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const std::string path = input;
+            std::ifstream file(path);
+            if (!file) {
+                std::cout << "couldn't open " << path << std::endl;
+                continue;
+            }
+            std::vector<mpz_class> moduli;
+            std::vector<size_t> line_numbers;
+            size_t line_number = 0;
+            while (std::getline(file, input)) {
+                ++line_number;
                 trim(input);
-                switch (input[0]) {
-                    case '1': {
-                        std::cout << "Enter the encrypted message: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class c(input);
-                        mpz_class m;
-                        mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
-                        std::cout << "Decrypted message: " << m << std::endl;
-                        crackLoop = false;
-                        break;
-                    }
-                    case '2': {
-                        std::cout << "Enter the encrypted message: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class c(input);
-                        mpz_class m;
-                        mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
-                        std::cout << "Decrypted message: " << mpz_to_ascii_string(m) << std::endl;
-                        crackLoop = false;
-                        break;
-                    }
-                    default: {
-                        std::cout << "Invalid choice" << std::endl;
-                    }
+                if (input.empty() || input[0] == '#') continue;
+                mpz_class n;
+                if (n.set_str(input, 10) != 0 || n < 4) {
+                    std::cout << "skipping line " << line_number << ", not a modulus" << std::endl;
+                    continue;
                 }
+                moduli.push_back(n);
+                line_numbers.push_back(line_number);
             }
+            uint64_t bound = BATCH_SMALL_FACTOR_BOUND;
+            std::cout << "Trial divide every n up to (" << bound << " if empty, 0 to skip): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) bound = std::stoull(input);
+
+            auto beginning = std::chrono::high_resolution_clock::now();
+            const unsigned int num_threads = detect_threads();
+            const std::string result_path = path + ".factors";
+            std::ofstream results(result_path, std::ios::trunc);
+            results << "# n p q d for e = " << e << '\n';
+            std::vector<bool> factored(moduli.size(), false);
+            size_t broken = 0, unsplit = 0;
+            auto record = [&](size_t i, const mpz_class& p) {
+                const mpz_class q = moduli[i] / p;
+                std::cout << "line " << line_numbers[i] << ": p = " << p << ", q = " << q << std::endl;
+                results << moduli[i] << ' ' << p << ' ' << q << ' ' << private_exponent(e, p, q) << '\n';
+                factored[i] = true;
+                ++broken;
+            };
+
+            if (bound >= 2) {
+                std::cout << "Looking for factors up to " << std::min(bound, MAX_SMALL_FACTOR_BOUND) << " in " << moduli.size() << " moduli..." << std::endl;
+                const std::vector<uint64_t> small = batch_small_factors(moduli, bound, num_threads);
+                for (size_t i = 0; i < moduli.size(); ++i) {
+                    if (small[i] != 0) record(i, mpz_from_u64(small[i]));
+                }
+            }
+
+            std::cout << "Looking for primes shared between " << moduli.size() << " moduli..." << std::endl;
+            const std::vector<mpz_class> shared = batch_gcd(moduli, num_threads);
+            for (size_t i = 0; i < moduli.size(); ++i) {
+                if (shared[i] == 1 || factored[i]) continue;
+                if (shared[i] == moduli[i]) {
+                    std::cout << "line " << line_numbers[i] << ": shares both primes with other moduli, or is listed twice" << std::endl;
+                    ++unsplit;
+                    continue;
+                }
+                record(i, shared[i]);
+            }
+            std::cout << "\nFactored " << broken << " of " << moduli.size() << " moduli";
+            if (unsplit > 0) std::cout << ", " << unsplit << " more share primes but couldn't be split";
+            std::cout << std::endl;
+            if (broken > 0) std::cout << "n, p, q and d of every factored modulus are in " << result_path << std::endl;
+            print_elapsed(beginning);
+            continue;
+        }
+
+        if (seq(input, "d") || seq(input, "deterministic") || seq(input, "strassen")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with Pollard-Strassen, deterministic and best up to ~70 bits..." << std::endl;
+            const unsigned threads = detect_threads();
+            const StrassenPlan plan = plan_pollard_strassen(n, threads);
+            std::cout << "blocks of d = " << plan.degree << " integers, " << plan.batches << " batches of d blocks on "
+                      << plan.threads << " threads" << std::endl;
+            if (plan.batches > plan.threads) {
+                std::cout << "memory keeps d below n^1/4, the batches grow as sqrt(n) / d^2 from here" << std::endl;
+            }
+
+            mpz_class p = pollard_strassen(n, threads);
+            if (p == 0) {
+                std::cout << "failed to factorize n" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "s") || seq(input, "siqs")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+            std::cout << "Trying to factorize n with the quadratic sieve, made for balanced n of 40-100 digits..." << std::endl;
+
+            mpz_class p = siqs_factor(n, detect_threads());
+            if (p == 0) {
+                std::cout << "failed to factorize n" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "h") || seq(input, "hastad") || seq(input, "broadcast")) {
+            //set e
+            mpz_class e("3");
+            std::cout << "Choose the exponent e all recipients use (3 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 3..." << std::endl;
+            if (e < 2 || !e.fits_ulong_p()) {
+                std::cout << "e has to be between 2 and " << ULONG_MAX << std::endl;
+                continue;
+            }
+
+            // one "n c" pair per line, empty lines and lines starting with # are skipped
+            std::cout << "Enter the path of a file with one \"n c\" pair per line, the same message under every n: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const std::string path = input;
+            std::ifstream file(path);
+            if (!file) {
+                std::cout << "couldn't open " << path << std::endl;
+                continue;
+            }
+            std::vector<mpz_class> moduli, ciphertexts;
+            size_t line_number = 0;
+            while (std::getline(file, input)) {
+                ++line_number;
+                trim(input);
+                if (input.empty() || input[0] == '#') continue;
+                std::istringstream fields(input);
+                std::string n_field, c_field;
+                mpz_class n, c;
+                if (!(fields >> n_field >> c_field) || n.set_str(n_field, 10) != 0 || c.set_str(c_field, 10) != 0 || n < 2) {
+                    std::cout << "skipping line " << line_number << ", not an \"n c\" pair" << std::endl;
+                    continue;
+                }
+                moduli.push_back(n);
+                ciphertexts.push_back(c);
+            }
+            if (moduli.empty()) {
+                std::cout << "no ciphertexts in " << path << std::endl;
+                continue;
+            }
+            // m < every n, so e ciphertexts always give m^e < n_1 * ... * n_e, fewer only do for short messages
+            if (moduli.size() < e) {
+                std::cout << "only " << moduli.size() << " ciphertexts for e = " << e << ", this only works if the message is short" << std::endl;
+            }
+
+            auto beginning = std::chrono::high_resolution_clock::now();
+            const ProductTree tree(moduli);
+            const std::optional<mpz_class> combined = tree.chinese_remainder(ciphertexts);
+            if (!combined) {
+                std::cout << "two of the moduli share a prime, [B]atch GCD factors them" << std::endl;
+                continue;
+            }
+            mpz_class m;
+            if (!small_message_root(*combined, e.get_ui(), tree.root(), SMALL_MESSAGE_MULTIPLES, m)) {
+                std::cout << "the combined ciphertext is no e-th power, the messages differ or are padded" << std::endl;
+                continue;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - beginning;
+            std::cout << "Combined " << moduli.size() << " ciphertexts and took the e-th root in " << elapsed.count() << " seconds" << std::endl;
+            std::cout << "Decrypted message: " << m << std::endl;
+            std::cout << "As a string: " << mpz_to_ascii_string(m) << std::endl;
+            continue;
+        }
+
+        if (seq(input, "m") || seq(input, "modulus") || seq(input, "common")) {
+            // one "e n c" triple per line, empty lines and lines starting with # are skipped
+            std::cout << "Enter the path of a file with one \"e n c\" triple per line: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const std::string path = input;
+            std::ifstream file(path);
+            if (!file) {
+                std::cout << "couldn't open " << path << std::endl;
+                continue;
+            }
+            std::vector<mpz_class> exponents, moduli, ciphertexts;
+            std::vector<size_t> line_numbers;
+            size_t line_number = 0;
+            while (std::getline(file, input)) {
+                ++line_number;
+                trim(input);
+                if (input.empty() || input[0] == '#') continue;
+                std::istringstream fields(input);
+                std::string e_field, n_field, c_field;
+                mpz_class e, n, c;
+                if (!(fields >> e_field >> n_field >> c_field) || e.set_str(e_field, 10) != 0 || n.set_str(n_field, 10) != 0
+                    || c.set_str(c_field, 10) != 0 || e < 1 || n < 2) {
+                    std::cout << "skipping line " << line_number << ", not an \"e n c\" triple" << std::endl;
+                    continue;
+                }
+                exponents.push_back(e);
+                moduli.push_back(n);
+                ciphertexts.push_back(c);
+                line_numbers.push_back(line_number);
+            }
+
+            auto beginning = std::chrono::high_resolution_clock::now();
+            const std::vector<RecoveredMessage> recovered = recover_common_modulus(exponents, moduli, ciphertexts, SMALL_MESSAGE_MULTIPLES);
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - beginning;
+            const std::string result_path = path + ".messages";
+            std::ofstream results(result_path, std::ios::trunc);
+            results << "# lines n m\n";
+            for (const RecoveredMessage& message : recovered) {
+                std::string lines;
+                for (size_t i : message.indices) lines += (lines.empty() ? "" : ",") + std::to_string(line_numbers[i]);
+                std::cout << "lines " << lines << ": " << message.m << " (\"" << mpz_to_ascii_string(message.m) << "\")" << std::endl;
+                results << lines << ' ' << moduli[message.indices.front()] << ' ' << message.m << '\n';
+            }
+            std::cout << "Decrypted " << recovered.size() << " messages out of " << moduli.size() << " ciphertexts in " << elapsed.count() << " seconds";
+            if (!recovered.empty()) std::cout << ", they are in " << result_path;
+            std::cout << std::endl;
+            continue;
+        }
+
+        if (seq(input, "k") || seq(input, "key") || seq(input, "boneh-durfee")) {
+            // the attack needs d small, so e is about as large as n and there is no default
+            std::cout << "Enter e from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            mpz_class e(input);
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            double delta = BONEH_DURFEE_DEFAULT_DELTA;
+            std::cout << "Bound on d as a power of n, below 0.29 (" << delta << " if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) delta = std::stod(input);
+            unsigned m = BONEH_DURFEE_DEFAULT_M;
+            std::cout << "Lattice parameter m, larger gets closer to the bound but is much slower (" << m << " if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) m = std::stoul(input);
+            auto beginning = std::chrono::high_resolution_clock::now();
+
+            if (mpz_class p = wiener_factor(e, n); p != 0) {
+                std::cout << "d is below n^0.25, Wiener's attack recovered it" << std::endl;
+                report_factors(e, n, p, n / p, beginning);
+                continue;
+            }
+            std::cout << "Reducing the Boneh-Durfee lattice, this might take a while..." << std::endl;
+            mpz_class p = boneh_durfee_factor(e, n, delta, m);
+            if (p == 0) {
+                std::cout << "failed to recover d, try a larger bound or a larger m" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "x") || seq(input, "exposure") || seq(input, "coppersmith")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            std::cout << "Are the [H]igh or the [L]ow bits of p known?: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const bool high = !(seq(input, "l") || seq(input, "low"));
+            std::cout << "Enter the known bits of p as the number they form (0x for hex): ";
+            std::getline(std::cin, input);
+            trim(input);
+            mpz_class known(input);
+            std::cout << (high ? "How many low bits of p are unknown: " : "How many low bits of p are known: ");
+            std::getline(std::cin, input);
+            trim(input);
+            const unsigned long bits = std::stoul(input);
+            auto beginning = std::chrono::high_resolution_clock::now();
+
+            // unknown bits up to about a quarter of n are in reach, more takes a larger lattice
+            std::cout << "Reducing the Coppersmith lattice, this might take a while..." << std::endl;
+            mpz_class p;
+            if (high) {
+                mpz_mul_2exp(known.get_mpz_t(), known.get_mpz_t(), bits);
+                p = factor_with_high_bits(n, known, bits);
+            } else {
+                p = factor_with_low_bits(n, known, bits);
+            }
+            if (p == 0) {
+                std::cout << "failed to factorize n, too many bits of p are unknown" << std::endl;
+                continue;
+            }
+            report_factors(e, n, p, n / p, beginning);
+            continue;
+        }
+
+        if (seq(input, "g") || seq(input, "related") || seq(input, "franklin-reiter")) {
+            //set e
+            mpz_class e("65537");
+            std::cout << "Choose an exponent e (65537 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) e=input;
+            else std::cout << "No input, defaulting to 65537..." << std::endl;
+            if (e < 2 || e > RELATED_MESSAGE_EXPONENT_LIMIT) {
+                std::cout << "e has to be between 2 and " << RELATED_MESSAGE_EXPONENT_LIMIT << " for the polynomial gcd" << std::endl;
+                continue;
+            }
+
+            // set n
+            mpz_class n;
+            std::cout << "Enter n from the public key: ";
+            std::getline(std::cin, input);
+            trim(input);
+            n = input;
+            std::cout << "Enter the first encrypted message c1: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const mpz_class c1(input);
+            std::cout << "Enter the second encrypted message c2: ";
+            std::getline(std::cin, input);
+            trim(input);
+            const mpz_class c2(input);
+            // the relation m2 = a*m1 + b
+            mpz_class a = 1, b = 0;
+            std::cout << "The messages are related by m2 = a*m1 + b, enter a (1 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) a = input;
+            std::cout << "Enter b (0 if empty): ";
+            std::getline(std::cin, input);
+            trim(input);
+            if (!seq(input, "")) b = input;
+            auto beginning = std::chrono::high_resolution_clock::now();
+
+            std::cout << "Taking the gcd of two polynomials of degree " << e << ", this might take a while..." << std::endl;
+            mpz_class m1;
+            if (!franklin_reiter(e.get_ui(), n, c1, c2, a, b, m1)) {
+                std::cout << "failed to decrypt, the relation doesn't hold or the gcd isn't linear" << std::endl;
+                continue;
+            }
+            const mpz_class m2 = ((a * m1 + b) % n + n) % n;
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - beginning;
+            std::cout << "The gcd is linear, its root is the first message, took " << elapsed.count() << " seconds" << std::endl;
+            std::cout << "Decrypted first message: " << m1 << std::endl;
+            std::cout << "As a string: " << mpz_to_ascii_string(m1) << std::endl;
+            std::cout << "Decrypted second message: " << m2 << std::endl;
+            std::cout << "As a string: " << mpz_to_ascii_string(m2) << std::endl;
             continue;
         }
 
@@ -626,6 +1510,7 @@ int main() {
                 std::cout << "     [D] find big dihedral Prime" << std::endl;
                 std::cout << "     [P] check if number is Prime with high certainty" << std::endl;
                 std::cout << "     [F] Factors are Known, decode message" << std::endl;
+                std::cout << "     [T] Tune the crackers for this machine" << std::endl;
                 std::cout << "     [B] Back" << std::endl;
                 std::cout << "     [Q] Quit" << std::endl;
                 std::cout << "Enter your choice: ";
@@ -813,6 +1698,17 @@ int main() {
                         }
                         break;
                     }
+                    case 't':
+                    case 'T': {
+                        std::cout << "Measuring this machine, this takes a few seconds..." << std::endl;
+                        tuning = run_autotune();
+                        if (save_tuning_profile(tuning, TUNING_PROFILE_FILE)) {
+                            std::cout << "saved tuning profile to " << TUNING_PROFILE_FILE << std::endl;
+                        } else {
+                            std::cout << "couldn't write " << TUNING_PROFILE_FILE << ", the profile is only used until the program exits" << std::endl;
+                        }
+                        break;
+                    }
                     case 'p':
                     case 'P': {
                         std::cout << "Enter Number: ";
@@ -837,23 +1733,48 @@ int main() {
                         }
                         else
                             e=65537;
-                        std::cout << "Enter p: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class p(input);
-                        std::cout << "Enter q: " << std::endl;
+                        std::cout << "Enter p (leave empty if only n is known): ";
                         std::getline(std::cin, input);
                         trim(input);
-                        mpz_class q(input);
+                        mpz_class p, q;
+                        std::optional<mpz_class> ciphertext;
+                        if (seq(input, "")) {
+                            // without the factors only a short message under a small e or a small d can be recovered
+                            std::cout << "Enter n: ";
+                            std::getline(std::cin, input);
+                            trim(input);
+                            mpz_class n_known(input);
+                            if (try_small_message(e, n_known, ciphertext)) break;
+                            p = wiener_factor(e, n_known);
+                            if (p == 0) {
+                                std::cout << "d is too large for Wiener's attack, trying Boneh-Durfee..." << std::endl;
+                                p = boneh_durfee_factor(e, n_known);
+                            }
+                            if (p == 0) {
+                                std::cout << "d is too large for a small d attack, factorize n with one of the cracking modes" << std::endl;
+                                break;
+                            }
+                            q = n_known / p;
+                            std::cout << "d is small, the attack found p = " << p << " and q = " << q << std::endl;
+                        } else {
+                            p = input;
+                            std::cout << "Enter q: " << std::endl;
+                            std::getline(std::cin, input);
+                            trim(input);
+                            q = input;
+                        }
                         mpz_class phi=(p-1)*(q-1);
                         mpz_class n=(p*q);
                         mpz_class d;
                         mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
                         std::cout << "private key is: " << d << std::endl;
-                        std::cout << "Enter the encrypted message: ";
-                        std::getline(std::cin, input);
-                        trim(input);
-                        mpz_class c(input);
+                        if (!ciphertext) {
+                            std::cout << "Enter the encrypted message: ";
+                            std::getline(std::cin, input);
+                            trim(input);
+                            ciphertext = mpz_class(input);
+                        }
+                        const mpz_class& c = *ciphertext;
                         mpz_class m;
                         mpz_powm(m.get_mpz_t(), c.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
                         std::cout << "Decrypted message: " << m << std::endl;